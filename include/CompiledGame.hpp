@@ -8,6 +8,7 @@
 #include <algorithm>
 
 #include "EnumHelpers.hpp"
+#include "PSUtils.hpp"
 
 using namespace std;
 
@@ -63,6 +64,9 @@ struct CompiledGame{
     {
         weak_ptr<CollisionLayer> collision_layer;
 
+        int id = -1; //dense index in CompiledGame::primary_objects, used as the object bit in level cells
+        int collision_layer_id = -1; //index in CompiledGame::collision_layers
+
         PrimaryObject(string p_id):Object(p_id){}
         virtual ~PrimaryObject() override {};
 
@@ -113,6 +117,19 @@ struct CompiledGame{
         bool is_object_on_layer(weak_ptr<PrimaryObject> p_object) const;
     };
 
+    //bitmask over primary object ids, a level cell is stored the same way
+    struct ObjectMask
+    {
+        vector<uint64_t> words;
+
+        ObjectMask(int p_word_count = 0):words(p_word_count,0){}
+
+        void set(int p_id) {words[p_id/64] |= (uint64_t)1 << (p_id%64);}
+        bool test(int p_id) const {return (words[p_id/64] >> (p_id%64)) & 1;}
+        bool is_empty() const;
+        bool intersects(const uint64_t* p_cell_words) const;
+    };
+
     //enum direction
     enum class RuleDirection{
         None,
@@ -225,6 +242,20 @@ struct CompiledGame{
         bool is_wildcard_cell = false;
 
         map<shared_ptr<Object>,EntityRuleInfo> content;
+
+        //the content lowered to bitmasks by the compiler (see Compiler::compile_cell_rules_masks), this is what the engine matches cells against
+        struct MovementRequirement
+        {
+            int object_id = -1; //the primary object whose movement is checked, -1 if it's the object found with any_of_objects[any_of_index]
+            int any_of_index = -1;
+            EntityRuleInfo rule_info = EntityRuleInfo::None;
+        };
+
+        bool can_never_match = false; //aggregates do not define any single object so a cell requiring one is never matched
+        ObjectMask required_objects; //all of them must be in the cell
+        ObjectMask forbidden_objects; //none of them can be in the cell
+        vector<ObjectMask> any_of_objects; //exactly one object of each mask must be in the cell (properties)
+        vector<MovementRequirement> movement_requirements;
     };
 
     struct Pattern
@@ -247,6 +278,10 @@ struct CompiledGame{
         ObjectDeltaType delta_type = ObjectDeltaType::None;
 
         bool is_optional = false;
+
+        //computed with the cell rules masks
+        int primary_object_id = -1; //set only when object is itself a primary object, it is then applied without being matched in the cell
+        ObjectMask object_mask; //the primary objects defined by object
     };
 
     struct Command
@@ -289,6 +324,7 @@ struct CompiledGame{
     struct Cell
     {
         vector<weak_ptr<PrimaryObject>> objects;
+        vector<int> object_ids; //ids of the objects, so that loading a level does not need to lock the weak pointers
     };
 
     struct Level
@@ -308,6 +344,10 @@ struct CompiledGame{
     PreludeInfo prelude_info;
     map<shared_ptr<PrimaryObject>,ObjectGraphicData> graphics_data;
     set<shared_ptr<Object>> objects;
+    //the engine stores object ids and collision layers on 16 bits in its level changes and turn history, the compiler rejects games with more objects
+    //there are at most as many collision layers as objects since an object can only be on one, plus the extra layer shared by the objects without one
+    static constexpr int MAX_PRIMARY_OBJECT_COUNT = UINT16_MAX;
+    vector<shared_ptr<PrimaryObject>> primary_objects; //indexed by PrimaryObject::id
     weak_ptr<Object> player_object;
     vector<shared_ptr<CollisionLayer>> collision_layers;
     vector<Rule> rules;
@@ -316,5 +356,8 @@ struct CompiledGame{
     vector<Level> levels;
     vector<vector<string>> levels_messages;
 
+    int get_object_mask_word_count() const {return ((int)primary_objects.size() + 63)/64;}
+    ObjectMask get_object_mask(const shared_ptr<Object>& p_obj) const;
+
     void print();
 };
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <cstdint>
+
+#include "CompiledGame.hpp"
+#include "PSLogger.hpp"
+
+using namespace std;
+
+//writes a compiled game to a binary buffer and reads it back, so that a game can be loaded without being parsed and compiled again
+//the buffer is keyed by a hash of the source text it was compiled from, a buffer whose key does not match the source is rejected
+//the values are stored with the byte order of the machine that wrote them, the buffers are meant to be cached locally
+class CompiledGameSerializer
+{
+public:
+    //to increment every time the layout of the buffer or of CompiledGame changes, or when the compiler output for the same source changes
+    static constexpr uint32_t FORMAT_VERSION = 2;
+
+    static uint64_t hash_source(string_view p_source_text);
+
+    static bool serialize(const CompiledGame& p_game, uint64_t p_source_hash, vector<uint8_t>& p_out_buffer, shared_ptr<PSLogger> p_logger);
+    static optional<CompiledGame> deserialize(const uint8_t* p_data, size_t p_size, uint64_t p_source_hash, shared_ptr<PSLogger> p_logger);
+
+    static bool save_to_file(const CompiledGame& p_game, uint64_t p_source_hash, const string& p_file_path, shared_ptr<PSLogger> p_logger);
+    //returns nullopt if there is no file or if it was written for another source or version, the file is read at once
+    static optional<CompiledGame> load_from_file(const string& p_file_path, uint64_t p_source_hash, shared_ptr<PSLogger> p_logger);
+
+protected:
+    CompiledGameSerializer(shared_ptr<PSLogger> p_logger);
+
+    shared_ptr<PSLogger> m_logger;
+    static const string m_serializer_log_cat;
+
+    //WRITING
+
+    vector<uint8_t>* m_out_buffer = nullptr;
+    //the objects are written as their index in the buffer, the primary objects come first so that their index is their id
+    unordered_map<const CompiledGame::Object*, int> m_object_indexes;
+    bool m_has_unknown_object = false;
+
+    template<typename T>
+    void write_value(T p_value);
+    void write_string(const string& p_string);
+    void write_object(const shared_ptr<CompiledGame::Object>& p_object);
+    void write_mask(const CompiledGame::ObjectMask& p_mask);
+    void write_rules(const vector<CompiledGame::Rule>& p_rules);
+    void write_game(const CompiledGame& p_game);
+
+    //READING
+
+    const uint8_t* m_cursor = nullptr;
+    const uint8_t* m_end = nullptr;
+    bool m_has_read_error = false; //set when the data ends early or holds an invalid index or count
+    vector<shared_ptr<CompiledGame::Object>> m_read_objects;
+    int m_read_primary_object_count = 0; //the values the engine uses as indexes are checked against it once the objects are read
+
+    template<typename T>
+    T read_value();
+    string read_string();
+    //reads a count and checks that the remaining data can hold that many elements of p_min_element_size bytes
+    uint32_t read_count(size_t p_min_element_size);
+    shared_ptr<CompiledGame::Object> read_object();
+    shared_ptr<CompiledGame::PrimaryObject> read_primary_object();
+    //the mask must have one bit per primary object, or no word at all if p_can_be_empty (the compiler does not compute the masks of the result patterns)
+    CompiledGame::ObjectMask read_mask(bool p_can_be_empty = false);
+    void read_rules(vector<CompiledGame::Rule>& p_rules);
+    bool read_game(CompiledGame& p_game);
+};
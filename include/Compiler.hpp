@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <optional>
+#include <unordered_map>
 
 #include "CompiledGame.hpp"
 #include "ParsedGame.hpp"
@@ -40,8 +41,17 @@ protected:
 
     void verify_rules_and_compute_deltas(vector<CompiledGame::Rule>& p_rules);
 
-    bool check_identifier_validity(const string& p_id, int p_identifier_line_numbler, bool p_should_already_exist);
-    weak_ptr<CompiledGame::Object> get_obj_by_id(const string& p_id);
+    void compile_cell_rules_masks(vector<CompiledGame::Rule>& p_rules);
+
+    //the declared objects by lowercased identifier, every level tile and rule identifier is looked up in it
+    unordered_map<string, shared_ptr<CompiledGame::Object>> m_objects_by_id;
+    string m_id_lookup_key; //reused to lowercase the looked up identifiers without allocating
+
+    void declare_object(shared_ptr<CompiledGame::Object> p_obj);
+    const string& get_id_lookup_key(string_view p_id);
+
+    bool check_identifier_validity(string_view p_id, int p_identifier_line_numbler, bool p_should_already_exist);
+    weak_ptr<CompiledGame::Object> get_obj_by_id(string_view p_id);
 
     bool retrieve_player_object();
     bool retrieve_background_objects();
@@ -50,8 +60,8 @@ protected:
     weak_ptr<CompiledGame::PrimaryObject> m_default_background_object;
 
     template<typename T>
-    void detect_error(Token<T> p_token, string p_error_msg, bool p_is_warning = false);
-    void detect_error(int p_line_number, string p_error_msg, bool p_is_warning = false);
+    void detect_error(const Token<T>& p_token, const string& p_error_msg, bool p_is_warning = false);
+    void detect_error(int p_line_number, const string& p_error_msg, bool p_is_warning = false);
 
 
 };
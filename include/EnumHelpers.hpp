@@ -1,12 +1,18 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <map>
+#include <algorithm>
 #include <optional>
 
 using namespace std;
 
 struct ci_less //code from https://stackoverflow.com/questions/1801892/how-can-i-make-the-mapfind-operation-case-insensitive
 {
+    //the maps using it can be searched with a string_view, without building a string
+    using is_transparent = void;
+
     // case-independent (ci) compare_less binary function
     struct nocase_compare
     {
@@ -14,7 +20,7 @@ struct ci_less //code from https://stackoverflow.com/questions/1801892/how-can-i
             return tolower (c1) < tolower (c2); 
         }
     };
-    bool operator() (const std::string & s1, const std::string & s2) const {
+    bool operator() (std::string_view s1, std::string_view s2) const {
         return std::lexicographical_compare 
         (s1.begin (), s1.end (),   // source range
         s2.begin (), s2.end (),   // dest range
@@ -24,16 +30,26 @@ struct ci_less //code from https://stackoverflow.com/questions/1801892/how-can-i
 
 struct ci_equal
 {
-	bool operator() (const std::string & s1, const std::string & s2)
+	bool operator() (std::string_view s1, std::string_view s2) const
 	{
-		ci_less comparator;
-		return !comparator(s1,s2) && !comparator(s2,s1);
+		if(s1.size() != s2.size())
+		{
+			return false;
+		}
+		for(size_t i = 0; i < s1.size(); ++i)
+		{
+			if(tolower((unsigned char)s1[i]) != tolower((unsigned char)s2[i]))
+			{
+				return false;
+			}
+		}
+		return true;
 	}
 };
 
 
 template <class E>
-std::optional<E> str_to_enum(string p_str, map<string,E,ci_less> p_mapping)
+std::optional<E> str_to_enum(std::string_view p_str, const map<string,E,ci_less>& p_mapping)
 {
 	auto it = p_mapping.find(p_str);
 	if(it != p_mapping.end())
@@ -48,9 +64,9 @@ std::optional<E> str_to_enum(string p_str, map<string,E,ci_less> p_mapping)
 }
 
 template <class E> //should throw exception instead ?
-optional<string> enum_to_str(E p_enum_value, map<string,E,ci_less> p_mapping)
+optional<string> enum_to_str(E p_enum_value, const map<string,E,ci_less>& p_mapping)
 {
-	for(auto pair : p_mapping)
+	for(const auto& pair : p_mapping)
 	{
 		if(pair.second == p_enum_value)
 		{
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+#include "CompiledGame.hpp"
+#include "PSLogger.hpp"
+
+using namespace std;
+
+//parses and compiles many game files at once on a pool of threads
+//every game is loaded by a task of its own, with its own parser, compiler and logger, so the tasks share nothing
+class PSCatalogLoader
+{
+public:
+
+    struct Config
+    {
+        //0 uses every core
+        int thread_count = 0;
+
+        //the messages below it are not recorded in the diagnostics
+        PSLogger::LogType log_verbosity = PSLogger::LogType::Warning;
+    };
+
+    struct Diagnostic
+    {
+        PSLogger::LogType type = PSLogger::LogType::None;
+        string category;
+        string message;
+    };
+
+    struct LoadedGame
+    {
+        shared_ptr<const CompiledGame> compiled_game; //null if the game could not be parsed or compiled
+        vector<Diagnostic> diagnostics;
+        uint64_t duration_ns = 0;
+    };
+
+    //keeps the messages of a task instead of printing them, so that the outputs of the tasks are not interleaved
+    class RecordingLogger : public PSLogger
+    {
+    public:
+        vector<Diagnostic> diagnostics;
+
+        virtual void log(LogType p_type, const std::string& p_category, const std::string& p_msg) override;
+    };
+
+    //the games by file path
+    static map<string, LoadedGame> load_games(const vector<string>& p_file_paths);
+    static map<string, LoadedGame> load_games(const vector<string>& p_file_paths, Config p_config);
+
+    //the paths of the files of a directory that have the extension, sorted
+    static vector<string> find_game_files(const string& p_directory_path, const string& p_extension = ".txt");
+
+protected:
+    static LoadedGame load_game(const string& p_file_path, const Config& p_config);
+};
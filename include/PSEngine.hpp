@@ -3,6 +3,9 @@
 #include <string>
 #include <map>
 #include <unordered_set>
+#include <unordered_map>
+#include <deque>
+#include <limits>
 
 #include "EnumHelpers.hpp"
 #include "CompiledGame.hpp"
@@ -10,22 +13,23 @@
 #include "PSUtils.hpp"
 
 
+//the log messages are only built if both the engine config and the logger accept their log type
 #define PS_LOG(p_log_msg){\
-    if(m_config.log_verbosity <= PSLogger::LogType::Log)\
+    if(is_log_enabled(PSLogger::LogType::Log))\
     {\
         m_logger->log(PSLogger::LogType::Log, m_engine_log_cat, p_log_msg);\
     }\
 }
 
 #define PS_LOG_VERBOSE(p_log_msg){\
-    if(m_config.log_verbosity <= PSLogger::LogType::VerboseLog)\
+    if(is_log_enabled(PSLogger::LogType::VerboseLog))\
     {\
         m_logger->log(PSLogger::LogType::VerboseLog, m_engine_log_cat, p_log_msg);\
     }\
 }
 
 #define PS_LOG_WARNING(p_log_msg){\
-    if(m_config.log_verbosity <= PSLogger::LogType::Warning)\
+    if(is_log_enabled(PSLogger::LogType::Warning))\
     {\
         m_logger->log(PSLogger::LogType::Warning, m_engine_log_cat, p_log_msg);\
         if(m_config.log_operation_history_after_error)\
@@ -36,7 +40,7 @@
 }
 
 #define PS_LOG_ERROR(p_log_msg){\
-    if(m_config.log_verbosity <= PSLogger::LogType::Error)\
+    if(is_log_enabled(PSLogger::LogType::Error))\
     {\
         m_logger->log(PSLogger::LogType::Error, m_engine_log_cat, p_log_msg);\
         if(m_config.log_operation_history_after_error)\
@@ -54,6 +58,22 @@ public:
         PSLogger::LogType log_verbosity = PSLogger::LogType::Warning;
         bool log_operation_history_after_error = true;
         bool add_ticks_to_operation_history = false;
+
+        //limits of the undo history, the oldest turns are forgotten first when one is reached. 0 means no limit
+        int undo_max_turns = 0;
+        size_t undo_max_memory_bytes = 0;
+
+        //fills the TurnStats of every turn, see get_last_turn_stats
+        bool collect_turn_stats = false;
+
+        //if false the turns returned by receive_input and tick are empty, only was_turn_cancelled is set
+        bool record_turn_history = true;
+
+        //if false the operations (inputs, level loads, undos...) are not kept, print_operation_history will print nothing
+        bool record_operation_history = true;
+
+        //a turn whose again chain goes beyond this number of subturns is cancelled. 0 means no limit
+        int max_subturns_per_turn = 1000;
     };
 
     enum ObjectMoveType
@@ -67,41 +87,147 @@ public:
         Stationary,
     };
 
-    struct Cell
-    {
-        PSVector2i position;
-        map<shared_ptr<CompiledGame::PrimaryObject>,ObjectMoveType> objects;
+    enum class AbsoluteDirection{
+        None,
+        Up,
+        Down,
+        Left,
+        Right,
+    };
+
+    static constexpr int ABSOLUTE_DIRECTION_COUNT = (int)AbsoluteDirection::Right + 1;
+
+    //object ids and collision layers as stored by the level changes and the turn history, the compiler keeps the games within its range
+    typedef uint16_t PackedIndex;
+    static_assert(CompiledGame::MAX_PRIMARY_OBJECT_COUNT <= std::numeric_limits<PackedIndex>::max(), "the object ids and collision layers of the compiled games must fit in a PackedIndex");
 
-        optional<shared_ptr<CompiledGame::PrimaryObject>> find_colliding_object(shared_ptr<CompiledGame::PrimaryObject> obj) const;
+    //a reversible change of the level, recorded by the level primitives while Level::is_recording_changes is set
+    struct LevelChange
+    {
+        enum class Type : uint8_t
+        {
+            ObjectAdded,
+            ObjectRemoved,
+            MovementChanged,
+        };
+
+        Type type;
+        uint8_t previous_movement; //only for MovementChanged
+        PackedIndex object_id_or_collision_layer;
+        int cell_idx;
+
+        LevelChange(Type p_type, int p_cell_idx, int p_object_id_or_collision_layer, uint8_t p_previous_movement = 0)
+        :type(p_type), previous_movement(p_previous_movement), object_id_or_collision_layer((PackedIndex)p_object_id_or_collision_layer), cell_idx(p_cell_idx){};
     };
 
+    //a level is stored as flat arrays : every cell has a fixed width bitmask of the primary objects it contains (indexed by PrimaryObject::id)
+    //and one ObjectMoveType nibble per collision layer for the movement of the object of this layer
+    //the level also indexes the positions of every object as a bitset over the cells, it is kept up to date by add_object and remove_object
     struct Level
     {
         int level_idx = -1;
         PSVector2i size;
-        vector<Cell> cells;
-    };
 
-    //todo we should probably encapsulate that in the level class
-    class ObjectCache{
-    public:
-        void build_cache(const Level p_level);
-        void add_object_position(const shared_ptr<CompiledGame::PrimaryObject> p_object,PSVector2i p_position);
-        void remove_object_position(const shared_ptr<CompiledGame::PrimaryObject> p_object,PSVector2i p_position);
-        unordered_set<PSVector2i> get_object_positions(const shared_ptr<CompiledGame::PrimaryObject> p_object);
-        string to_string();
-    private:
-        map<const shared_ptr<CompiledGame::PrimaryObject>,unordered_set<PSVector2i>> m_content;
-    };
+        int object_words_per_cell = 0;
+        int movement_bytes_per_cell = 0;
+        int position_words_per_object = 0;
+        vector<uint64_t> objects;
+        vector<uint8_t> movements;
+        vector<uint64_t> object_positions;
+
+        //change_stamp is incremented on every change of the level, the value it reached is saved for the object or collision layer that changed
+        //they are used to skip the rules for which nothing changed since they last failed to match (see PSEngine::is_rule_dirty)
+        uint64_t change_stamp = 1;
+        vector<uint64_t> object_change_stamps; //indexed by object id
+        vector<uint64_t> movement_change_stamps; //indexed by collision layer
+
+        bool is_recording_changes = false;
+        vector<LevelChange> recorded_changes;
+
+        //zobrist hash of the objects and movements of the level, kept up to date by add_object, remove_object and set_movement
+        //two levels with the same content have the same hash, whatever the order of the changes that led to it
+        //this relies on the engine never leaving a movement on a collision layer that has no object in the cell
+        uint64_t state_hash = 0;
+
+        //the keys are mixed from the position instead of being stored in a table, stationary movements have no key so that a new level hashes to 0
+        static uint64_t get_object_hash_key(int p_cell_idx, int p_object_id) {return mix_bits(((uint64_t)p_cell_idx << 32) | ((uint64_t)p_object_id << 4));}
+        static uint64_t get_movement_hash_key(int p_cell_idx, int p_collision_layer, ObjectMoveType p_move_type)
+        {
+            return p_move_type == ObjectMoveType::Stationary ? 0 : mix_bits((((uint64_t)p_cell_idx << 32) | ((uint64_t)p_collision_layer << 4) | (uint64_t)p_move_type) ^ 0x5bd1e9955bd1e995ULL);
+        }
 
-    enum class AbsoluteDirection{
-        None,
-        Up,
-        Down,
-        Left,
-        Right,
+        //index offset to the neighbour cell and number of cells to the edge of the level, indexed by AbsoluteDirection
+        int direction_strides[ABSOLUTE_DIRECTION_COUNT] = {};
+        vector<int> distances_to_edge; //ABSOLUTE_DIRECTION_COUNT per cell
+
+        void init(int p_level_idx, PSVector2i p_size, int p_object_count, int p_collision_layer_count);
+
+        int get_cell_count() const {return size.x*size.y;}
+        int get_cell_index(PSVector2i p_position) const;
+        PSVector2i get_cell_position(int p_cell_idx) const {return PSVector2i(p_cell_idx % size.x, p_cell_idx / size.x);}
+        int get_distance_to_edge(int p_cell_idx, AbsoluteDirection p_direction) const {return distances_to_edge[p_cell_idx*ABSOLUTE_DIRECTION_COUNT + (int)p_direction];}
+        //returns -1 if the cell is out of bounds
+        int get_cell_from(int p_cell_idx, int p_distance, AbsoluteDirection p_direction) const
+        {
+            return p_distance <= get_distance_to_edge(p_cell_idx, p_direction) ? p_cell_idx + p_distance*direction_strides[(int)p_direction] : -1;
+        }
+
+        const uint64_t* get_cell_objects(int p_cell_idx) const {return &objects[p_cell_idx*object_words_per_cell];}
+        //allocates the result, only meant for printing and debugging. The hot paths loop over the words of get_cell_objects
+        vector<int> get_objects_in_cell(int p_cell_idx) const;
+        bool has_object(int p_cell_idx, int p_object_id) const {return (objects[p_cell_idx*object_words_per_cell + p_object_id/64] >> (p_object_id%64)) & 1;}
+        void add_object(int p_cell_idx, int p_object_id)
+        {
+            if(has_object(p_cell_idx, p_object_id))
+            {
+                return;
+            }
+            if(is_recording_changes)
+            {
+                recorded_changes.push_back(LevelChange(LevelChange::Type::ObjectAdded, p_cell_idx, p_object_id));
+            }
+            objects[p_cell_idx*object_words_per_cell + p_object_id/64] |= (uint64_t)1 << (p_object_id%64);
+            object_positions[p_object_id*position_words_per_object + p_cell_idx/64] |= (uint64_t)1 << (p_cell_idx%64);
+            object_change_stamps[p_object_id] = ++change_stamp;
+            state_hash ^= get_object_hash_key(p_cell_idx, p_object_id);
+        }
+        void remove_object(int p_cell_idx, int p_object_id)
+        {
+            if(!has_object(p_cell_idx, p_object_id))
+            {
+                return;
+            }
+            if(is_recording_changes)
+            {
+                recorded_changes.push_back(LevelChange(LevelChange::Type::ObjectRemoved, p_cell_idx, p_object_id));
+            }
+            objects[p_cell_idx*object_words_per_cell + p_object_id/64] &= ~((uint64_t)1 << (p_object_id%64));
+            object_positions[p_object_id*position_words_per_object + p_cell_idx/64] &= ~((uint64_t)1 << (p_cell_idx%64));
+            object_change_stamps[p_object_id] = ++change_stamp;
+            state_hash ^= get_object_hash_key(p_cell_idx, p_object_id);
+        }
+
+        //bitset of the cells containing the object, position_words_per_object words long
+        const uint64_t* get_object_positions(int p_object_id) const {return &object_positions[p_object_id*position_words_per_object];}
+        //fills p_out_cells with the bitset of the cells containing at least one object of the mask
+        void get_cells_containing(const CompiledGame::ObjectMask& p_object_mask, vector<uint64_t>& p_out_cells) const;
+        string object_positions_to_string() const;
+
+        ObjectMoveType get_movement(int p_cell_idx, int p_collision_layer) const;
+        void set_movement(int p_cell_idx, int p_collision_layer, ObjectMoveType p_move_type);
+
+        //applies the inverse of the change, it is never recorded
+        void revert_change(const LevelChange& p_change);
     };
 
+    static constexpr int OBJECT_MOVE_TYPE_COUNT = ObjectMoveType::Stationary + 1;
+    static constexpr int ENTITY_RULE_INFO_COUNT = (int)CompiledGame::EntityRuleInfo::No + 1;
+
+    //a set of ObjectMoveType stored as bits, used by the precomputed movement tables of the rule matcher
+    typedef uint8_t MoveTypeMask;
+    static constexpr MoveTypeMask ALL_MOVE_TYPES_MASK = (1 << OBJECT_MOVE_TYPE_COUNT) - 1;
+    static constexpr MoveTypeMask move_type_bit(ObjectMoveType p_move_type) {return (MoveTypeMask)(1 << p_move_type);}
+
     struct PatternMatchInformation
     {
         vector<int> wildcard_pattern_cell_indexes;
@@ -109,19 +235,36 @@ public:
         PSVector2i origin;
     };
 
+    //what a rule reads in the level, a rule that did not match does not need to be evaluated again until one of these changes
+    struct RuleReadInfo
+    {
+        CompiledGame::ObjectMask objects;
+        vector<int> movement_collision_layers;
+        uint64_t no_match_stamp = 0; //level change stamp when the rule last failed to match, 0 if it has to be evaluated
+    };
+
+    //the cells a pattern can start from, found by intersecting the positions of the objects of one of its rule cells (the anchor)
+    struct PatternCandidates
+    {
+        bool is_restricted = false; //if false the pattern can start from any cell of the level
+        int anchor_distance = 0; //distance between the pattern origin and the anchor rule cell
+        vector<uint64_t> anchor_cells; //bitset of the cells that could match the anchor rule cell
+    };
+
+    //the deltas only reference cells, objects and rules by index, use get_cell_position, get_primary_object and get_rule to resolve them
     struct ObjectDelta
     {
-        PSVector2i cell_position;
-        shared_ptr<CompiledGame::PrimaryObject> object;
+        int cell_idx;
+        PackedIndex object_id;
         CompiledGame::ObjectDeltaType type;
 
-        ObjectDelta(PSVector2i p_cell_position, shared_ptr<CompiledGame::PrimaryObject> p_object, CompiledGame::ObjectDeltaType p_type)
-        :cell_position(p_cell_position), object(p_object), type(p_type){};
+        ObjectDelta(int p_cell_idx, int p_object_id, CompiledGame::ObjectDeltaType p_type)
+        :cell_idx(p_cell_idx), object_id((PackedIndex)p_object_id), type(p_type){};
 
         friend bool operator==(const ObjectDelta& lhs, const ObjectDelta& rhs){
-            bool result = lhs.object == rhs.object;
+            bool result = lhs.object_id == rhs.object_id;
             result &= lhs.type == rhs.type;
-            result &= lhs.cell_position == rhs.cell_position;
+            result &= lhs.cell_idx == rhs.cell_idx;
             return result;
         }
     };
@@ -129,20 +272,32 @@ public:
     struct RuleApplicationDelta
     {
         AbsoluteDirection rule_direction;
-        vector<PatternMatchInformation> match_infos;
+        vector<int> match_origins; //the cell each pattern of the rule was matched from
         vector<ObjectDelta> object_deltas;
 
         friend bool operator==(const RuleApplicationDelta& lhs, const RuleApplicationDelta& rhs){
             return lhs.object_deltas == rhs.object_deltas;
         }
+
+        //consistent with operator==, only the object deltas are hashed
+        uint64_t hash() const{
+            uint64_t result = object_deltas.size();
+            for(const ObjectDelta& obj_delta : object_deltas)
+            {
+                result = hash_combine(result, (uint64_t)obj_delta.cell_idx);
+                result = hash_combine(result, (uint64_t)obj_delta.object_id);
+                result = hash_combine(result, (uint64_t)obj_delta.type);
+            }
+            return result;
+        }
     };
 
     struct MovementDelta
     {
-        PSVector2i origin;
-        PSVector2i destination;
+        int origin_cell_idx;
+        int destination_cell_idx;
+        PackedIndex object_id;
         AbsoluteDirection move_direction;
-        shared_ptr<CompiledGame::PrimaryObject> object;
         bool moved_successfully = false;
     };
 
@@ -154,7 +309,8 @@ public:
         vector<MovementDelta> movement_deltas;
 
         //params for a rule delta
-        CompiledGame::Rule rule_applied;
+        int rule_idx = -1;
+        bool is_late_rule = false;
         vector<RuleApplicationDelta> rule_application_deltas;
     };
 
@@ -183,8 +339,6 @@ public:
     struct SubturnHistory
     {
         vector<RuleDelta> steps;
-
-        vector<CompiledGame::Command> gather_all_subturn_commands() const;
     };
 
     struct TurnHistory
@@ -192,6 +346,37 @@ public:
         vector<SubturnHistory> subturns;
 
         bool was_turn_cancelled = false;
+        //the again chain of the turn looped or went beyond Config::max_subturns_per_turn, the turn was cancelled
+        bool was_turn_aborted = false;
+    };
+
+    struct RuleStats
+    {
+        int evaluations = 0;
+        int skips = 0; //times the rule was not evaluated since nothing it reads changed
+        int candidate_cells = 0; //cells the patterns of the rule were matched from
+        int matches = 0; //pattern matches, before they are combined
+        int applied_deltas = 0;
+        uint64_t duration_ns = 0;
+    };
+
+    //counters and timings of the work done during a turn, only filled if Config::collect_turn_stats is set
+    struct TurnStats
+    {
+        vector<RuleStats> rules; //indexed like CompiledGame::rules
+        vector<RuleStats> late_rules; //indexed like CompiledGame::late_rules
+
+        int subturns = 0;
+
+        int movement_resolutions = 0;
+        int move_attempts = 0;
+        int successful_moves = 0;
+        uint64_t movement_duration_ns = 0;
+
+        int win_condition_checks = 0;
+        uint64_t win_conditions_duration_ns = 0;
+
+        uint64_t turn_duration_ns = 0;
     };
 
     struct Operation{
@@ -215,6 +400,9 @@ public:
     PSEngine(shared_ptr<PSLogger> p_logger = nullptr);
     PSEngine(Config p_config, shared_ptr<PSLogger> p_logger = nullptr);
 
+    //the engine keeps a reference to the game, it is not copied
+    void load_game(shared_ptr<const CompiledGame> p_game_to_load);
+    //copies the game, prefer the shared_ptr overload to share a game between engines
     void load_game(const CompiledGame& p_game_to_load);
 
     void Load_first_level();
@@ -225,6 +413,24 @@ public:
 
     optional<TurnHistory> tick(float p_delta_time);
 
+    struct SimulationResult
+    {
+        bool is_level_won = false;
+        int inputs_played = 0; //the inputs of a sequence stop being played as soon as the level is won
+        Level final_state; //only filled if it was requested
+    };
+
+    //plays every input sequence from the start of the level, without any logging or history, and returns one result per sequence
+    //returns no result if the level index is invalid
+    static vector<SimulationResult> simulate_input_sequences(shared_ptr<const CompiledGame> p_game, int p_level_idx, const vector<vector<InputType>>& p_input_sequences, bool p_keep_final_states = false);
+
+    //replaces the objects and movements of the current level by the ones of another state of the same level (laid out like Level::objects and Level::movements)
+    //only the cells that differ are changed, the undo history is cleared and the level is not won anymore
+    void restore_level_content(const uint64_t* p_objects, const uint8_t* p_movements);
+
+    //estimated number of turns to win the level : cells breaking an "all" or "no" win condition plus one per unsatisfied "some" win condition
+    int get_win_conditions_distance();
+
     void restart_level();
     bool undo();
 
@@ -232,17 +438,30 @@ public:
 
     bool is_level_won() const;
 
-    int get_number_of_levels() const {return (int)m_compiled_game.levels.size();}
+    int get_number_of_levels() const {return (int)m_compiled_game->levels.size();}
 
-    vector<string> get_messages_before_level(int p_level_idx) const {return m_compiled_game.levels_messages[p_level_idx];}
-    vector<string> get_messages_after_level(int p_level_idx) const {return m_compiled_game.levels_messages[p_level_idx+1];}
+    vector<string> get_messages_before_level(int p_level_idx) const {return m_compiled_game->levels_messages[p_level_idx];}
+    vector<string> get_messages_after_level(int p_level_idx) const {return m_compiled_game->levels_messages[p_level_idx+1];}
 
     void print_game_state(); //todo making this const will require a few changes and maybe some mutables
 
     Level get_level_state() const {return m_current_level;};
+    const Level& get_current_level() const {return m_current_level;}
+    //hash of the objects and movements of the current level, equal levels have equal hashes
+    uint64_t get_level_hash() const {return m_current_level.state_hash;}
+    //hash of a new level built from the objects of the current one and the movements of their collision layers
+    //it differs from get_level_hash if a movement was left on an empty layer or if the incremental hash went wrong
+    uint64_t compute_rebuilt_level_hash() const;
 
     TurnHistory get_turn_deltas() {return m_turn_history;}
 
+    PSVector2i get_cell_position(int p_cell_idx) const {return m_current_level.get_cell_position(p_cell_idx);}
+    const shared_ptr<CompiledGame::PrimaryObject>& get_primary_object(int p_object_id) const {return m_compiled_game->primary_objects[p_object_id];}
+    const CompiledGame::Rule& get_rule(int p_rule_idx, bool p_is_late_rule) const {return p_is_late_rule ? m_compiled_game->late_rules[p_rule_idx] : m_compiled_game->rules[p_rule_idx];}
+
+    const TurnStats& get_last_turn_stats() const {return m_turn_stats;}
+    string turn_stats_to_string() const;
+
     string operation_history_to_string() const;
     void print_operation_history() const;
 
@@ -255,14 +474,40 @@ protected:
     shared_ptr<PSLogger> m_logger;
     static const string m_engine_log_cat;
 
+    bool is_log_enabled(PSLogger::LogType p_type) const
+    {
+        return PSLogger::is_compiled(p_type) && m_config.log_verbosity <= p_type && m_logger->is_enabled(p_type);
+    }
+
     void load_level_internal(int p_level_idx);
 
+    void record_operation(const Operation& p_operation);
+
     optional<TurnHistory> next_turn();
+    //reverts the changes of the turn being computed and returns its history
+    TurnHistory cancel_turn(TurnHistory& p_last_turn_history_save, uint64_t p_turn_start_time);
 
     bool next_subturn();
 
-    void apply_rule(const CompiledGame::Rule& p_rule);
-    optional<unordered_set<PSVector2i>> find_cells_for_rule_application(const CompiledGame::Rule& p_rule);
+    //applies the rule and fills p_rule_stats if it is not null
+    bool process_rule(int p_rule_idx, bool p_is_late_rule, RuleStats* p_rule_stats);
+
+    //returns true if the rule matched somewhere in the level
+    bool apply_rule(int p_rule_idx, bool p_is_late_rule);
+
+    void compute_rules_read_infos(const vector<CompiledGame::Rule>& p_rules, vector<RuleReadInfo>& p_out_read_infos);
+    bool is_rule_dirty(const RuleReadInfo& p_read_info) const;
+    //to call when the level is replaced by another one since the change stamps are not comparable anymore
+    void invalidate_rules_read_infos();
+
+    //rolls the level back to the state it had when it started recording and stops the recording
+    void revert_recorded_changes();
+    void push_undo_turn(const vector<LevelChange>& p_turn_changes);
+    void forget_oldest_undo_turn();
+    //fills m_pattern_candidates_scratch with the candidates of every pattern of the rule, returns false if one of the patterns cannot match anywhere
+    bool find_cells_for_rule_application(const CompiledGame::Rule& p_rule);
+    //fills p_out_cells with the bitset of the cells that could match the rule cell, returns false if any cell could match it
+    bool find_cells_for_cell_rule(const CompiledGame::CellRule& p_cell_rule, vector<uint64_t>& p_out_cells);
 
     void apply_delta(const RuleApplicationDelta& p_delta);
 
@@ -270,42 +515,62 @@ protected:
 
     bool basic_movement_resolution();
 
-    bool try_to_move_object(Cell& p_containing_cell, shared_ptr<CompiledGame::PrimaryObject> p_type_of_object_moved, RuleDelta& p_movement_deltas);
+    bool try_to_move_object(int p_containing_cell_idx, int p_object_id, RuleDelta& p_movement_deltas);
+
+    //returns the object of the cell on the collision layer of p_object_id (the lowest id if there are several), -1 if there is none
+    int find_colliding_object(int p_cell_idx, int p_object_id) const;
+    int find_object_in_cell(int p_cell_idx, const CompiledGame::ObjectMask& p_mask) const;
 
     bool advanced_movement_resolution();
 
     bool check_win_conditions();
-    bool check_win_condition(const CompiledGame::WinCondition& p_win_condition);
+    bool check_win_condition(int p_win_condition_idx);
 
-    vector<PatternMatchInformation> match_pattern(const CompiledGame::Pattern& p_pattern, AbsoluteDirection p_rule_application_direction, optional<unordered_set<PSVector2i>> p_application_positions);
+    void match_pattern(const CompiledGame::Pattern& p_pattern, AbsoluteDirection p_rule_application_direction, const PatternCandidates& p_candidates, vector<PatternMatchInformation>& p_out_matches);
+    string match_origins_to_string(AbsoluteDirection p_rule_app_dir, const vector<int>& p_match_origins) const;
 
-    bool does_rule_cell_matches_cell(const CompiledGame::CellRule& p_rule_cell, const Cell* p_cell, AbsoluteDirection p_rule_application_direction);
+    bool does_rule_cell_matches_cell(const CompiledGame::CellRule& p_rule_cell, int p_cell_idx, AbsoluteDirection p_rule_application_direction);
 
-    set<AbsoluteDirection> get_absolute_directions_from_rule_direction(CompiledGame::RuleDirection p_rule_direction);
+    const vector<AbsoluteDirection>& get_absolute_directions_from_rule_direction(CompiledGame::RuleDirection p_rule_direction);
 
-    optional<set<ObjectMoveType>> convert_entity_rule_info_to_allowed_move_types(CompiledGame::EntityRuleInfo p_entity_rule_info, AbsoluteDirection p_rule_app_dir);
     bool does_move_info_matches_rule(ObjectMoveType p_move_type, CompiledGame::EntityRuleInfo p_rule_info, AbsoluteDirection p_rule_dir);
 
     bool get_move_destination_coord(PSVector2i p_origin, ObjectMoveType p_move_type, PSVector2i& p_out_destination);
 
     RuleApplicationDelta translate_rule_delta(const CompiledGame::Rule& p_rule, AbsoluteDirection p_rule_app_dir, const vector<PatternMatchInformation>& p_pattern_match_infos);
 
-    Cell* get_cell_from(PSVector2i p_origin, int p_distance, AbsoluteDirection p_direction);
-    Cell* get_cell_at(PSVector2i p_position);
-    Cell* get_cell_at(int p_index);
+    //these return the index of the cell in the level or -1 if it's out of bounds
+    int get_cell_from(int p_origin_cell_idx, int p_distance, AbsoluteDirection p_direction) const {return m_current_level.get_cell_from(p_origin_cell_idx, p_distance, p_direction);}
+    int get_cell_at(PSVector2i p_position);
 
 
     string get_single_char_obj_alias(const string& p_obj_id);
 
-    CompiledGame m_compiled_game;
+    //the compiled game is never modified once loaded, several engines (possibly on different threads) can share it
+    shared_ptr<const CompiledGame> m_compiled_game = make_shared<const CompiledGame>();
+
+    int m_collision_layer_count = 0;
+    vector<int> m_object_collision_layers; //indexed by object id
+    vector<CompiledGame::ObjectMask> m_collision_layer_masks; //objects of every collision layer, indexed by collision layer
+    CompiledGame::ObjectMask m_player_mask;
+    vector<pair<CompiledGame::ObjectMask,CompiledGame::ObjectMask>> m_win_condition_masks; //object and on_object masks
+    vector<RuleReadInfo> m_rules_read_infos; //indexed like m_compiled_game.rules
+    vector<RuleReadInfo> m_late_rules_read_infos; //indexed like m_compiled_game.late_rules
 
     Level m_current_level;
 
-    vector<Level> m_level_state_stack;
+    //the undo history is the changes of every turn, stored one after the other, and the number of changes of each turn
+    deque<LevelChange> m_undo_changes;
+    deque<int> m_undo_turns_change_counts;
 
     vector<Operation> m_operation_history;
 
     TurnHistory m_turn_history;
+    vector<CompiledGame::Command> m_subturn_commands; //commands of the rules applied during the current subturn
+    vector<uint64_t> m_subturn_level_hashes; //level hash after every completed subturn of the current turn, to detect again loops
+
+    TurnStats m_turn_stats;
+    RuleStats* m_current_rule_stats = nullptr; //stats of the rule being applied, null if the stats are not collected
 
     InputType m_last_input = InputType::None;
 
@@ -315,5 +580,17 @@ protected:
 
     float m_current_tick_time_elapsed = 0;
 
-    ObjectCache m_object_cache;
+    //scratch cells bitsets
+    vector<PatternCandidates> m_pattern_candidates_scratch; //indexed by pattern
+    vector<uint64_t> m_cell_rule_cells_scratch;
+    vector<uint64_t> m_entity_cells_scratch;
+    vector<uint64_t> m_win_condition_cells_scratch;
+
+    vector<int> m_objects_to_move_scratch; //moving objects of the cell being resolved by advanced_movement_resolution
+
+    //scratch buffers reused by apply_rule to avoid allocating for every rule
+    vector<vector<PatternMatchInformation>> m_pattern_matches_scratch; //indexed by pattern
+    vector<PatternMatchInformation> m_match_combination_scratch;
+    vector<int> m_match_combination_indexes_scratch;
+    unordered_multimap<uint64_t,int> m_rule_application_delta_hashes; //hash -> index in the rule application deltas
 };
@@ -2,6 +2,21 @@
 
 #include <string>
 
+//defining PS_STRIP_VERBOSE_LOGS compiles out every VerboseLog and Log message, only warnings and errors remain
+#ifdef PS_STRIP_VERBOSE_LOGS
+#define PS_MIN_COMPILED_LOG_TYPE PSLogger::LogType::Warning
+#else
+#define PS_MIN_COMPILED_LOG_TYPE PSLogger::LogType::VerboseLog
+#endif
+
+//the message is only built if the logger is going to print it
+#define PS_LOGGER_LOG(p_logger, p_log_type, p_category, p_log_msg){\
+    if(PSLogger::is_compiled(p_log_type) && (p_logger)->is_enabled(p_log_type))\
+    {\
+        (p_logger)->log(p_log_type, p_category, p_log_msg);\
+    }\
+}
+
 class PSLogger
 {
 public:
@@ -20,5 +35,9 @@ public:
 
     LogType log_verbosity = LogType::Warning;
 
-    virtual void log(LogType p_type, std::string p_category, std::string p_msg);
+    static constexpr bool is_compiled(LogType p_type) {return p_type >= PS_MIN_COMPILED_LOG_TYPE;}
+    bool is_enabled(LogType p_type) const {return p_type >= log_verbosity;}
+
+    //the categories are static strings of the classes that log, they are passed by reference and never copied
+    virtual void log(LogType p_type, const std::string& p_category, const std::string& p_msg);
 };
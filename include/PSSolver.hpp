@@ -0,0 +1,144 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+
+#include "CompiledGame.hpp"
+#include "PSEngine.hpp"
+#include "PSLogger.hpp"
+
+//explores the states reachable from the start of a level by playing inputs until one of them wins the level
+//the states are expanded by several engines sharing the compiled game, one per thread, and deduplicated in a hashed visited table
+class PSSolver
+{
+public:
+
+    enum class SearchType
+    {
+        BreadthFirst, //the solutions found are the shortest ones
+        AStar, //guided by PSEngine::get_win_conditions_distance, finds solutions faster but they are not always the shortest
+    };
+
+    enum class Status
+    {
+        Solved,
+        Unsolvable, //every reachable state was visited
+        LimitReached,
+        InvalidLevel,
+    };
+
+    struct Config
+    {
+        SearchType search_type = SearchType::BreadthFirst;
+
+        //0 uses every core
+        int thread_count = 0;
+
+        //the search stops when one is reached. 0 means no limit
+        size_t max_visited_states = 200000;
+        int max_solution_length = 0;
+
+        vector<PSEngine::InputType> inputs = {PSEngine::InputType::Up, PSEngine::InputType::Down, PSEngine::InputType::Left, PSEngine::InputType::Right, PSEngine::InputType::Action};
+    };
+
+    struct Result
+    {
+        int level_idx = -1;
+        Status status = Status::InvalidLevel;
+        vector<PSEngine::InputType> solution;
+        size_t visited_states = 0;
+        int explored_depth = 0;
+        uint64_t duration_ns = 0;
+    };
+
+    static constexpr int TEST_RECORD_VERSION = 1;
+
+    static std::map<string,Status, ci_less> to_status;
+
+    PSSolver(shared_ptr<const CompiledGame> p_game, shared_ptr<PSLogger> p_logger = nullptr);
+    PSSolver(shared_ptr<const CompiledGame> p_game, Config p_config, shared_ptr<PSLogger> p_logger = nullptr);
+
+    Result solve_level(int p_level_idx);
+    vector<Result> solve_all_levels();
+
+    //writes a record file that main.cpp's run_tests can replay, the solved levels are recorded with their solution and the others as not won
+    static bool write_test_record(const string& p_record_file_path, const string& p_game_file_name, const vector<Result>& p_results);
+
+    //the characters main.cpp uses for the inputs, 0 if the input has none
+    static char input_to_record_char(PSEngine::InputType p_input);
+
+protected:
+
+    //a visited state, never modified once it is in the visited table
+    struct Node
+    {
+        vector<uint64_t> content; //the objects of the level followed by its movements packed in words
+        uint64_t hash = 0; //the level hash maintained by the engine
+        const Node* parent = nullptr;
+        PSEngine::InputType input = PSEngine::InputType::None; //the input played from the parent
+        int depth = 0;
+        int cost = 0; //depth plus the heuristic for an AStar search, the nodes are expanded by increasing cost
+        bool is_won = false; //a win command can win a level whose content was already visited, so it is part of the state
+    };
+
+    //the visited table is split in shards, each with its own lock, so that the workers rarely wait for each other
+    struct VisitedShard
+    {
+        std::mutex mutex;
+        deque<Node> nodes; //a deque so that the nodes never move
+        unordered_multimap<uint64_t, const Node*> nodes_by_hash;
+    };
+
+    static constexpr int VISITED_SHARD_COUNT = 64;
+
+    //a range of the nodes to expand, claimed by chunks by its owner and stolen by the other workers once their own range is done
+    struct WorkRange
+    {
+        std::atomic<size_t> next{0};
+        size_t end = 0;
+    };
+
+    struct Worker
+    {
+        unique_ptr<PSEngine> engine;
+        vector<const Node*> children;
+        const Node* solution = nullptr;
+    };
+
+    Config m_config;
+    shared_ptr<PSLogger> m_logger;
+    static const string m_solver_log_cat;
+
+    shared_ptr<const CompiledGame> m_compiled_game;
+
+    int m_object_word_count = 0;
+    int m_content_word_count = 0;
+
+    vector<VisitedShard> m_visited_shards;
+    std::atomic<size_t> m_visited_state_count{0};
+
+    //set by the workers to stop the search early
+    std::atomic<bool> m_solution_found{false};
+    std::atomic<bool> m_limit_reached{false};
+    std::atomic<bool> m_depth_limit_reached{false};
+
+    vector<Worker> m_workers;
+    deque<WorkRange> m_work_ranges;
+
+    //returns the node added to the visited table, or null if the state was already visited
+    const Node* visit_state(vector<uint64_t>&& p_content, uint64_t p_hash, bool p_is_won, const Node* p_parent, PSEngine::InputType p_input, int p_depth, int p_cost);
+    void clear_visited_states();
+
+    void copy_level_content(const PSEngine::Level& p_level, vector<uint64_t>& p_out_content) const;
+
+    //expands the nodes of the work ranges, starting with the one of the worker and then stealing from the others
+    void expand_nodes(int p_worker_idx, const vector<const Node*>& p_nodes);
+    void expand_node(Worker& p_worker, const Node* p_node);
+
+    vector<PSEngine::InputType> get_solution_inputs(const Node* p_node) const;
+};
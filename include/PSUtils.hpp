@@ -3,6 +3,10 @@
 #include <cstdint>
 #include <functional>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 struct PSVector2i
 {
     int x;
@@ -32,3 +36,41 @@ namespace std {
         }
     };
 }
+
+inline uint64_t hash_combine(uint64_t p_seed, uint64_t p_value)
+{
+    return p_seed ^ (p_value + 0x9e3779b97f4a7c15ULL + (p_seed << 6) + (p_seed >> 2));
+}
+
+//splitmix64 finalizer, spreads every bit of the value over the whole result
+inline uint64_t mix_bits(uint64_t p_value)
+{
+    p_value ^= p_value >> 30;
+    p_value *= 0xbf58476d1ce4e5b9ULL;
+    p_value ^= p_value >> 27;
+    p_value *= 0x94d049bb133111ebULL;
+    p_value ^= p_value >> 31;
+    return p_value;
+}
+
+//returns the index of the lowest set bit of p_bits and clears it, p_bits must not be 0
+inline int pop_lowest_bit_index(uint64_t& p_bits)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, p_bits);
+#else
+    int index = __builtin_ctzll(p_bits);
+#endif
+    p_bits &= p_bits - 1;
+    return (int)index;
+}
+
+inline int bit_count(uint64_t p_bits)
+{
+#ifdef _MSC_VER
+    return (int)__popcnt64(p_bits);
+#else
+    return __builtin_popcountll(p_bits);
+#endif
+}
@@ -4,25 +4,39 @@
 #include <map>
 #include <string>
 #include <iostream>
+#include <memory>
+#include <deque>
+#include <string_view>
 
 #include "EnumHelpers.hpp"
+#include "TextProvider.hpp"
 
+//the literal is a view into the source of the ParsedGame the token belongs to, it is only valid as long as one of its copies lives
 template<typename E>
 struct Token{
 	E token_type;
-	string str_value;
+	string_view str_value;
 	int token_line;
 
-	Token(E p_token_type, string p_literal, int p_line)
+	Token(E p_token_type, string_view p_literal, int p_line)
 	: token_type(p_token_type), str_value(p_literal), token_line(p_line){}
 
-	void print(map<string,E, ci_less> p_enum_to_str) const {
+	void print(const map<string,E, ci_less>& p_enum_to_str) const {
 		cout << "l." << token_line << " : " << enum_to_str(token_type,p_enum_to_str).value_or("ERROR") << " | literal : \""<< str_value<<"\"\n";
 	}
 };
 
 struct ParsedGame{
 
+    //the text the tokens point into, shared by the copies of the parsed game so that their tokens stay valid
+    struct Source
+    {
+        unique_ptr<TextProvider> text_provider; //owns the text
+        deque<string> literals; //the few literals that are not a slice of the text (ie: a prelude literal containing a comment)
+    };
+
+    shared_ptr<Source> source;
+
     enum class PreludeTokenType{
         None,
         Title,
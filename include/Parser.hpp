@@ -7,6 +7,8 @@
 #include <map>
 #include <optional>
 #include <memory>
+#include <string_view>
+#include <cstdint>
 
 #include "EnumHelpers.hpp"
 #include "PSLogger.hpp"
@@ -47,7 +49,9 @@ protected:
 
 
 	void parse_comment(int p_comment_level = 0);
-	string parse_word();
+	//returns a slice of the text, the cursor is left on the last char of the word
+	string_view parse_word();
+	static bool is_word_delimiter(char p_char);
 	void parse_equals_row();
 	bool try_parse_return(bool consume = true);
 
@@ -86,6 +90,40 @@ protected:
 
 	unique_ptr<TextProvider> m_text_provider;
 
+	//the parser scans the text of the provider with a cursor, the current char is '\0' once the end of the text is reached
+	string_view m_text;
+	int64_t m_position = -1; //index of the current char in the text, -1 before the first advance
+	char m_current_char = '\0';
+
+	bool is_text_valid() const {return m_position < (int64_t)m_text.size();}
+	char current_char() const {return m_current_char;}
+	void set_position(int64_t p_position)
+	{
+		m_position = p_position;
+		m_current_char = m_position < (int64_t)m_text.size() ? m_text[m_position] : '\0';
+	}
+	char advance()
+	{
+		if(is_text_valid())
+		{
+			set_position(m_position + 1);
+		}
+		else
+		{
+			m_current_char = '\0';
+		}
+		return m_current_char;
+	}
+	void reverse()
+	{
+		if(is_text_valid() && m_position > 0)
+		{
+			set_position(m_position - 1);
+		}
+	}
+	char peek() const {return m_position + 1 < (int64_t)m_text.size() ? m_text[m_position + 1] : '\0';}
+	char peek_next() const {return m_position + 2 < (int64_t)m_text.size() ? m_text[m_position + 2] : '\0';}
+
 	shared_ptr<PSLogger> m_logger;
 
 	static const string m_parser_log_cat;
@@ -101,68 +139,35 @@ protected:
 
 protected:
 
+	//only consumes the word under the cursor if it is "message", the rest of the line is then the message content
 	template <class TokenType>
 	bool try_parse_message(vector<Token<TokenType>>& tokens_array)
 	{
-		string temp_buffer = "";
-		temp_buffer.push_back(m_text_provider->get_current_char());
-
-		bool detected_word_end = false;
-		while(m_text_provider->is_valid() && !detected_word_end)
+		size_t word_start = (size_t)m_position;
+		size_t word_end = word_start;
+		while(word_end < m_text.size() && m_text[word_end] != ' ' && m_text[word_end] != '\n' && m_text[word_end] != '\r')
 		{
-			m_text_provider->advance();
-			if(try_parse_return(false))
-			{
-				detected_word_end = true;
-			}
-			else
-			{
-				switch(m_text_provider->get_current_char())
-				{
-					case ' ':
-						detected_word_end = true;
-					break;
-					default:
-						temp_buffer.push_back(m_text_provider->get_current_char());
-					break;
-				}
-			}
+			++word_end;
 		}
 
 		ci_equal equal_comp;
-		if(equal_comp("Message",temp_buffer))
+		if(!equal_comp("Message", m_text.substr(word_start, word_end - word_start)))
 		{
-			//add token message and parse the rest
-			tokens_array.push_back(Token<TokenType>(TokenType::MESSAGE,"",m_line_counter));
-
-			temp_buffer.clear();
-
-			detected_word_end = false;
-			while(m_text_provider->is_valid() && !detected_word_end)
-			{
-				m_text_provider->advance();
-				if(try_parse_return(false))
-				{
-					detected_word_end = true;
-					m_text_provider->reverse();
-				}
-				else
-				{
-					temp_buffer.push_back(m_text_provider->get_current_char());
-				}
-			}
-			tokens_array.push_back(Token<TokenType>(TokenType::MessageContent,temp_buffer,m_line_counter));
-
-			return true;
+			return false;
 		}
-		else
+
+		tokens_array.push_back(Token<TokenType>(TokenType::MESSAGE,"",m_line_counter));
+
+		size_t content_start = (word_end < m_text.size() && m_text[word_end] == ' ') ? word_end + 1 : word_end;
+		size_t content_end = content_start;
+		while(content_end < m_text.size() && m_text[content_end] != '\n' && m_text[content_end] != '\r')
 		{
-			//reverse everything and return false, we couldn't properly parse a message token
-			for(auto it = temp_buffer.rbegin(); it != temp_buffer.rend(); it++)
-			{
-				m_text_provider->reverse();
-			}
-			return false;
+			++content_end;
 		}
+		tokens_array.push_back(Token<TokenType>(TokenType::MessageContent,m_text.substr(content_start, content_end - content_start),m_line_counter));
+
+		//the cursor is left before the line ending so that the section parser sees it
+		set_position(content_end < m_text.size() ? (int64_t)content_end - 1 : (int64_t)m_text.size());
+		return true;
 	}
 };
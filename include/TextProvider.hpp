@@ -1,9 +1,11 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <memory>
 #include <optional>
 #include <fstream>
+#include <cstdint>
 
 using namespace std;
 
@@ -20,6 +22,9 @@ public:
     virtual void reverse()=0;
     virtual char peek()=0;
     virtual char peek_next()=0;
+
+    //the whole text as a contiguous buffer, valid as long as the provider lives. The parser scans it directly
+    virtual string_view get_text()=0;
     
     int get_current_char_index(){return m_current_char_idx;}
     char get_current_char(){return m_current_char;}
@@ -43,6 +48,7 @@ public:
     virtual void reverse() override;
     virtual char peek() override;
     virtual char peek_next() override;
+    virtual string_view get_text() override {return m_text;}
 
 protected:
     string m_text;
@@ -60,8 +66,36 @@ public:
     virtual void reverse() override;
     virtual char peek() override;
     virtual char peek_next() override;
+    //reads the whole file the first time it is called
+    //advance returns the last char a second time at the end of the file, the text has no such extra char
+    virtual string_view get_text() override;
 
 protected:
     string m_file_path;
     ifstream m_file;
-};
\ No newline at end of file
+    string m_text;
+};
+
+//maps the whole file in memory, every operation is a read of the mapped buffer
+class TextProviderMappedFile : public TextProvider
+{
+public:
+    TextProviderMappedFile(shared_ptr<PSLogger> p_logger, string p_file_path);
+    virtual ~TextProviderMappedFile();
+
+    TextProviderMappedFile(const TextProviderMappedFile&) = delete;
+    TextProviderMappedFile& operator=(const TextProviderMappedFile&) = delete;
+
+    virtual bool is_valid() override;
+    virtual char advance() override;
+    virtual void reverse() override;
+    virtual char peek() override;
+    virtual char peek_next() override;
+    virtual string_view get_text() override {return string_view(m_data, m_size);}
+
+protected:
+    string m_file_path;
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+    int64_t m_position = -1; //index of the current char in the buffer, -1 before the first advance
+};
@@ -156,6 +156,49 @@ bool CompiledGame::CollisionLayer::is_object_on_layer(weak_ptr<PrimaryObject> p_
     return false;
 }
 
+bool CompiledGame::ObjectMask::is_empty() const
+{
+    for(uint64_t word : words)
+    {
+        if(word != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CompiledGame::ObjectMask::intersects(const uint64_t* p_cell_words) const
+{
+    for(int i = 0; i < words.size(); ++i)
+    {
+        if((words[i] & p_cell_words[i]) != 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+CompiledGame::ObjectMask CompiledGame::get_object_mask(const shared_ptr<Object>& p_obj) const
+{
+    ObjectMask mask(get_object_mask_word_count());
+
+    if(p_obj == nullptr || p_obj->is_aggregate())
+    {
+        //aggregates never define a single object, see AggregateObject::defines
+        return mask;
+    }
+
+    vector<weak_ptr<PrimaryObject>> prim_objs;
+    p_obj->GetAllPrimaryObjects(prim_objs);
+    for(const auto& prim_obj : prim_objs)
+    {
+        mask.set(prim_obj.lock()->id);
+    }
+    return mask;
+}
+
 string CompiledGame::Rule::to_string(bool with_deltas /*=false*/) const
 {
     string result = "";
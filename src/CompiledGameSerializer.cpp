@@ -0,0 +1,777 @@
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <type_traits>
+
+#include "CompiledGameSerializer.hpp"
+#include "PSUtils.hpp"
+
+using namespace std;
+
+static const char FILE_MAGIC[4] = {'P','S','C','G'};
+
+enum class SerializedObjectType : uint8_t
+{
+    Primary,
+    Alias,
+    Aggregate,
+    Properties,
+};
+
+const string CompiledGameSerializer::m_serializer_log_cat = "serializer";
+
+CompiledGameSerializer::CompiledGameSerializer(shared_ptr<PSLogger> p_logger) : m_logger(p_logger)
+{
+    if(m_logger == nullptr)
+    {
+        cout << "A Logger ptr was not passed to the serializer constructor, construction a default one\n";
+        m_logger = make_shared<PSLogger>(PSLogger());
+    }
+}
+
+uint64_t CompiledGameSerializer::hash_source(string_view p_source_text)
+{
+    uint64_t hash = mix_bits(p_source_text.size());
+
+    size_t i = 0;
+    for(; i + sizeof(uint64_t) <= p_source_text.size(); i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, p_source_text.data() + i, sizeof(uint64_t));
+        hash = mix_bits(hash_combine(hash, word));
+    }
+
+    //data() can be null for an empty text, memcpy must not be given it even with a 0 size
+    uint64_t last_word = 0;
+    if(i < p_source_text.size())
+    {
+        memcpy(&last_word, p_source_text.data() + i, p_source_text.size() - i);
+    }
+    return mix_bits(hash_combine(hash, last_word));
+}
+
+bool CompiledGameSerializer::serialize(const CompiledGame& p_game, uint64_t p_source_hash, vector<uint8_t>& p_out_buffer, shared_ptr<PSLogger> p_logger)
+{
+    CompiledGameSerializer serializer(p_logger);
+    serializer.m_out_buffer = &p_out_buffer;
+
+    p_out_buffer.assign(FILE_MAGIC, FILE_MAGIC + sizeof(FILE_MAGIC));
+    serializer.write_value(FORMAT_VERSION);
+    serializer.write_value(p_source_hash);
+
+    serializer.write_game(p_game);
+
+    if(serializer.m_has_unknown_object)
+    {
+        PS_LOGGER_LOG(serializer.m_logger, PSLogger::LogType::Error, m_serializer_log_cat, "the game references an object that is not in its objects, it cannot be serialized.");
+        p_out_buffer.clear();
+        return false;
+    }
+
+    return true;
+}
+
+optional<CompiledGame> CompiledGameSerializer::deserialize(const uint8_t* p_data, size_t p_size, uint64_t p_source_hash, shared_ptr<PSLogger> p_logger)
+{
+    CompiledGameSerializer serializer(p_logger);
+    serializer.m_cursor = p_data;
+    serializer.m_end = p_data + p_size;
+
+    if(p_size < sizeof(FILE_MAGIC) || memcmp(p_data, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0)
+    {
+        PS_LOGGER_LOG(serializer.m_logger, PSLogger::LogType::Error, m_serializer_log_cat, "the data is not a serialized compiled game.");
+        return nullopt;
+    }
+    serializer.m_cursor += sizeof(FILE_MAGIC);
+
+    uint32_t version = serializer.read_value<uint32_t>();
+    if(serializer.m_has_read_error || version != FORMAT_VERSION)
+    {
+        PS_LOGGER_LOG(serializer.m_logger, PSLogger::LogType::Log, m_serializer_log_cat, "the serialized compiled game was written with format version " + to_string(version) + " instead of " + to_string(FORMAT_VERSION) + ".");
+        return nullopt;
+    }
+
+    uint64_t source_hash = serializer.read_value<uint64_t>();
+    if(serializer.m_has_read_error || source_hash != p_source_hash)
+    {
+        PS_LOGGER_LOG(serializer.m_logger, PSLogger::LogType::Log, m_serializer_log_cat, "the serialized compiled game was compiled from another source.");
+        return nullopt;
+    }
+
+    CompiledGame game;
+    if(!serializer.read_game(game))
+    {
+        PS_LOGGER_LOG(serializer.m_logger, PSLogger::LogType::Error, m_serializer_log_cat, "the serialized compiled game is corrupted.");
+        return nullopt;
+    }
+
+    return game;
+}
+
+bool CompiledGameSerializer::save_to_file(const CompiledGame& p_game, uint64_t p_source_hash, const string& p_file_path, shared_ptr<PSLogger> p_logger)
+{
+    vector<uint8_t> buffer;
+    if(!serialize(p_game, p_source_hash, buffer, p_logger))
+    {
+        return false;
+    }
+
+    ofstream file(p_file_path, ios::out | ios::binary | ios::trunc);
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    if(!file.good())
+    {
+        if(p_logger != nullptr)
+        {
+            PS_LOGGER_LOG(p_logger, PSLogger::LogType::Error, m_serializer_log_cat, "could not write the serialized compiled game to " + p_file_path + ".");
+        }
+        return false;
+    }
+
+    return true;
+}
+
+optional<CompiledGame> CompiledGameSerializer::load_from_file(const string& p_file_path, uint64_t p_source_hash, shared_ptr<PSLogger> p_logger)
+{
+    ifstream file(p_file_path, ios::in | ios::binary | ios::ate);
+    if(!file.is_open())
+    {
+        return nullopt;
+    }
+
+    vector<uint8_t> buffer((size_t)file.tellg());
+    file.seekg(0);
+    if(!file.read(reinterpret_cast<char*>(buffer.data()), buffer.size()))
+    {
+        return nullopt;
+    }
+
+    return deserialize(buffer.data(), buffer.size(), p_source_hash, p_logger);
+}
+
+//WRITING
+
+template<typename T>
+void CompiledGameSerializer::write_value(T p_value)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "only plain values can be written");
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&p_value);
+    m_out_buffer->insert(m_out_buffer->end(), bytes, bytes + sizeof(T));
+}
+
+void CompiledGameSerializer::write_string(const string& p_string)
+{
+    write_value((uint32_t)p_string.size());
+    m_out_buffer->insert(m_out_buffer->end(), p_string.begin(), p_string.end());
+}
+
+void CompiledGameSerializer::write_object(const shared_ptr<CompiledGame::Object>& p_object)
+{
+    if(p_object == nullptr)
+    {
+        write_value((int32_t)-1);
+        return;
+    }
+
+    auto found_index = m_object_indexes.find(p_object.get());
+    if(found_index == m_object_indexes.end())
+    {
+        m_has_unknown_object = true;
+        write_value((int32_t)-1);
+        return;
+    }
+    write_value((int32_t)found_index->second);
+}
+
+void CompiledGameSerializer::write_mask(const CompiledGame::ObjectMask& p_mask)
+{
+    write_value((uint32_t)p_mask.words.size());
+    for(uint64_t word : p_mask.words)
+    {
+        write_value(word);
+    }
+}
+
+void CompiledGameSerializer::write_rules(const vector<CompiledGame::Rule>& p_rules)
+{
+    write_value((uint32_t)p_rules.size());
+    for(const CompiledGame::Rule& rule : p_rules)
+    {
+        write_value((int32_t)rule.rule_line);
+        write_value((uint8_t)rule.is_late_rule);
+        write_value((int32_t)rule.direction);
+
+        for(const vector<CompiledGame::Pattern>* patterns : {&rule.match_patterns, &rule.result_patterns})
+        {
+            write_value((uint32_t)patterns->size());
+            for(const CompiledGame::Pattern& pattern : *patterns)
+            {
+                write_value((uint32_t)pattern.cells.size());
+                for(const CompiledGame::CellRule& cell : pattern.cells)
+                {
+                    write_value((uint8_t)cell.is_wildcard_cell);
+
+                    write_value((uint32_t)cell.content.size());
+                    for(const auto& content : cell.content)
+                    {
+                        write_object(content.first);
+                        write_value((int32_t)content.second);
+                    }
+
+                    write_value((uint8_t)cell.can_never_match);
+                    write_mask(cell.required_objects);
+                    write_mask(cell.forbidden_objects);
+
+                    write_value((uint32_t)cell.any_of_objects.size());
+                    for(const CompiledGame::ObjectMask& mask : cell.any_of_objects)
+                    {
+                        write_mask(mask);
+                    }
+
+                    write_value((uint32_t)cell.movement_requirements.size());
+                    for(const CompiledGame::CellRule::MovementRequirement& requirement : cell.movement_requirements)
+                    {
+                        write_value((int32_t)requirement.object_id);
+                        write_value((int32_t)requirement.any_of_index);
+                        write_value((int32_t)requirement.rule_info);
+                    }
+                }
+            }
+        }
+
+        write_value((uint32_t)rule.commands.size());
+        for(const CompiledGame::Command& command : rule.commands)
+        {
+            write_value((int32_t)command.type);
+            write_string(command.message);
+        }
+
+        write_value((uint32_t)rule.deltas.size());
+        for(const CompiledGame::Delta& delta : rule.deltas)
+        {
+            write_value((int32_t)delta.pattern_index);
+            write_value((int32_t)delta.delta_match_index);
+            write_value((int32_t)delta.delta_application_index);
+            write_object(delta.object);
+            write_value((int32_t)delta.delta_type);
+            write_value((uint8_t)delta.is_optional);
+            write_value((int32_t)delta.primary_object_id);
+            write_mask(delta.object_mask);
+        }
+    }
+}
+
+void CompiledGameSerializer::write_game(const CompiledGame& p_game)
+{
+    const CompiledGame::PreludeInfo& prelude = p_game.prelude_info;
+    for(const optional<string>* info : {&prelude.title, &prelude.author, &prelude.homepage})
+    {
+        write_value((uint8_t)info->has_value());
+        write_string(info->value_or(""));
+    }
+    write_value((uint8_t)prelude.realtime_interval.has_value());
+    write_value(prelude.realtime_interval.value_or(0.0f));
+
+    //the primary objects first, in the order of their ids, then the other objects
+    vector<shared_ptr<CompiledGame::Object>> objects(p_game.primary_objects.begin(), p_game.primary_objects.end());
+    for(const shared_ptr<CompiledGame::Object>& obj : p_game.objects)
+    {
+        if(obj->as_primary_object() == nullptr)
+        {
+            objects.push_back(obj);
+        }
+    }
+
+    m_object_indexes.clear();
+    for(int i = 0; i < objects.size(); ++i)
+    {
+        m_object_indexes[objects[i].get()] = i;
+    }
+
+    write_value((uint32_t)p_game.primary_objects.size());
+    write_value((uint32_t)objects.size());
+    for(const shared_ptr<CompiledGame::Object>& obj : objects)
+    {
+        if(shared_ptr<CompiledGame::PrimaryObject> primary_obj = obj->as_primary_object())
+        {
+            write_value(SerializedObjectType::Primary);
+            write_string(obj->identifier);
+            write_value((int32_t)primary_obj->collision_layer_id);
+        }
+        else if(shared_ptr<CompiledGame::AliasObject> alias_obj = obj->as_alias_object())
+        {
+            write_value(SerializedObjectType::Alias);
+            write_string(obj->identifier);
+            write_object(alias_obj->referenced_object.lock());
+        }
+        else
+        {
+            const CompiledGame::GroupObject* group_obj = static_cast<const CompiledGame::GroupObject*>(obj.get());
+            write_value(group_obj->is_aggregate() ? SerializedObjectType::Aggregate : SerializedObjectType::Properties);
+            write_string(obj->identifier);
+            write_value((uint32_t)group_obj->referenced_objects.size());
+            for(const weak_ptr<CompiledGame::Object>& ref_obj : group_obj->referenced_objects)
+            {
+                write_object(ref_obj.lock());
+            }
+        }
+    }
+
+    write_object(p_game.player_object.lock());
+
+    write_value((uint32_t)p_game.collision_layers.size());
+    for(const shared_ptr<CompiledGame::CollisionLayer>& col_layer : p_game.collision_layers)
+    {
+        write_value((uint32_t)col_layer->objects.size());
+        for(const weak_ptr<CompiledGame::PrimaryObject>& obj : col_layer->objects)
+        {
+            write_object(obj.lock());
+        }
+    }
+
+    write_value((uint32_t)p_game.graphics_data.size());
+    for(const auto& data : p_game.graphics_data)
+    {
+        write_object(data.first);
+
+        write_value((uint32_t)data.second.colors.size());
+        for(const CompiledGame::Color& color : data.second.colors)
+        {
+            write_value((int32_t)color.name);
+            write_string(color.hexcode);
+        }
+
+        write_value((uint32_t)data.second.pixels.size());
+        for(int pixel : data.second.pixels)
+        {
+            write_value((int32_t)pixel);
+        }
+    }
+
+    write_rules(p_game.rules);
+    write_rules(p_game.late_rules);
+
+    write_value((uint32_t)p_game.win_conditions.size());
+    for(const CompiledGame::WinCondition& win_condition : p_game.win_conditions)
+    {
+        write_value((int32_t)win_condition.type);
+        write_object(win_condition.object);
+        write_object(win_condition.on_object);
+    }
+
+    write_value((uint32_t)p_game.levels.size());
+    for(const CompiledGame::Level& level : p_game.levels)
+    {
+        write_value((int32_t)level.width);
+        write_value((int32_t)level.height);
+        write_value((uint32_t)level.cells.size());
+        for(const CompiledGame::Cell& cell : level.cells)
+        {
+            write_value((uint32_t)cell.object_ids.size());
+            for(int object_id : cell.object_ids)
+            {
+                write_value((int32_t)object_id);
+            }
+        }
+    }
+
+    write_value((uint32_t)p_game.levels_messages.size());
+    for(const vector<string>& messages : p_game.levels_messages)
+    {
+        write_value((uint32_t)messages.size());
+        for(const string& message : messages)
+        {
+            write_string(message);
+        }
+    }
+}
+
+//READING
+
+template<typename T>
+T CompiledGameSerializer::read_value()
+{
+    static_assert(std::is_trivially_copyable<T>::value, "only plain values can be read");
+
+    T value{};
+    if(m_end - m_cursor < (ptrdiff_t)sizeof(T))
+    {
+        m_has_read_error = true;
+        m_cursor = m_end;
+        return value;
+    }
+
+    memcpy(&value, m_cursor, sizeof(T));
+    m_cursor += sizeof(T);
+    return value;
+}
+
+string CompiledGameSerializer::read_string()
+{
+    uint32_t size = read_count(1);
+    string result(reinterpret_cast<const char*>(m_cursor), size);
+    m_cursor += size;
+    return result;
+}
+
+uint32_t CompiledGameSerializer::read_count(size_t p_min_element_size)
+{
+    uint32_t count = read_value<uint32_t>();
+    if((size_t)(m_end - m_cursor) / p_min_element_size < count)
+    {
+        m_has_read_error = true;
+        m_cursor = m_end;
+        return 0;
+    }
+    return count;
+}
+
+shared_ptr<CompiledGame::Object> CompiledGameSerializer::read_object()
+{
+    int32_t index = read_value<int32_t>();
+    if(index == -1)
+    {
+        return nullptr;
+    }
+
+    if(index < 0 || index >= m_read_objects.size() || m_read_objects[index] == nullptr)
+    {
+        m_has_read_error = true;
+        return nullptr;
+    }
+    return m_read_objects[index];
+}
+
+shared_ptr<CompiledGame::PrimaryObject> CompiledGameSerializer::read_primary_object()
+{
+    shared_ptr<CompiledGame::Object> obj = read_object();
+    shared_ptr<CompiledGame::PrimaryObject> primary_obj = obj != nullptr ? obj->as_primary_object() : nullptr;
+    if(primary_obj == nullptr)
+    {
+        m_has_read_error = true;
+    }
+    return primary_obj;
+}
+
+CompiledGame::ObjectMask CompiledGameSerializer::read_mask(bool p_can_be_empty)
+{
+    CompiledGame::ObjectMask mask(read_count(sizeof(uint64_t)));
+    if(!(p_can_be_empty && mask.words.empty()) && mask.words.size() != (m_read_primary_object_count + 63)/64)
+    {
+        m_has_read_error = true;
+        m_cursor = m_end;
+        return CompiledGame::ObjectMask();
+    }
+
+    for(uint64_t& word : mask.words)
+    {
+        word = read_value<uint64_t>();
+    }
+    return mask;
+}
+
+void CompiledGameSerializer::read_rules(vector<CompiledGame::Rule>& p_rules)
+{
+    p_rules.resize(read_count(1));
+    for(CompiledGame::Rule& rule : p_rules)
+    {
+        rule.rule_line = read_value<int32_t>();
+        rule.is_late_rule = read_value<uint8_t>() != 0;
+        rule.direction = (CompiledGame::RuleDirection)read_value<int32_t>();
+
+        for(vector<CompiledGame::Pattern>* patterns : {&rule.match_patterns, &rule.result_patterns})
+        {
+            //the masks are only computed for the cells that are matched
+            const bool are_masks_computed = patterns == &rule.match_patterns;
+            patterns->resize(read_count(1));
+            for(CompiledGame::Pattern& pattern : *patterns)
+            {
+                pattern.cells.resize(read_count(1));
+                for(CompiledGame::CellRule& cell : pattern.cells)
+                {
+                    cell.is_wildcard_cell = read_value<uint8_t>() != 0;
+
+                    uint32_t content_count = read_count(1);
+                    for(uint32_t i = 0; i < content_count; ++i)
+                    {
+                        shared_ptr<CompiledGame::Object> obj = read_object();
+                        cell.content[obj] = (CompiledGame::EntityRuleInfo)read_value<int32_t>();
+                    }
+
+                    cell.can_never_match = read_value<uint8_t>() != 0;
+                    cell.required_objects = read_mask(!are_masks_computed);
+                    cell.forbidden_objects = read_mask(!are_masks_computed);
+
+                    cell.any_of_objects.resize(read_count(1));
+                    for(CompiledGame::ObjectMask& mask : cell.any_of_objects)
+                    {
+                        mask = read_mask(!are_masks_computed);
+                    }
+
+                    cell.movement_requirements.resize(read_count(1));
+                    for(CompiledGame::CellRule::MovementRequirement& requirement : cell.movement_requirements)
+                    {
+                        requirement.object_id = read_value<int32_t>();
+                        requirement.any_of_index = read_value<int32_t>();
+                        requirement.rule_info = (CompiledGame::EntityRuleInfo)read_value<int32_t>();
+
+                        //the movement of either a primary object or of the object found with one of the any_of masks is checked
+                        bool is_object_valid = requirement.object_id == -1
+                            ? requirement.any_of_index >= 0 && requirement.any_of_index < cell.any_of_objects.size()
+                            : requirement.object_id >= 0 && requirement.object_id < m_read_primary_object_count;
+                        if(!is_object_valid)
+                        {
+                            m_has_read_error = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        rule.commands.resize(read_count(1));
+        for(CompiledGame::Command& command : rule.commands)
+        {
+            command.type = (CompiledGame::CommandType)read_value<int32_t>();
+            command.message = read_string();
+        }
+
+        uint32_t delta_count = read_count(1);
+        for(uint32_t i = 0; i < delta_count; ++i)
+        {
+            int pattern_index = read_value<int32_t>();
+            int delta_match_index = read_value<int32_t>();
+            int delta_application_index = read_value<int32_t>();
+            shared_ptr<CompiledGame::Object> obj = read_object();
+            CompiledGame::ObjectDeltaType delta_type = (CompiledGame::ObjectDeltaType)read_value<int32_t>();
+
+            rule.deltas.emplace_back(pattern_index, delta_match_index, delta_application_index, obj, delta_type);
+            CompiledGame::Delta& delta = rule.deltas.back();
+            delta.is_optional = read_value<uint8_t>() != 0;
+            delta.primary_object_id = read_value<int32_t>();
+            delta.object_mask = read_mask();
+
+            //the pattern is an index in the match patterns, the cells of the delta are offsets from the origin of its match
+            if(pattern_index < 0 || pattern_index >= rule.match_patterns.size()
+                || delta_match_index < 0 || delta_match_index >= rule.match_patterns[pattern_index].cells.size()
+                || delta_application_index < 0 || delta_application_index >= rule.match_patterns[pattern_index].cells.size()
+                || delta.primary_object_id < -1 || delta.primary_object_id >= m_read_primary_object_count)
+            {
+                m_has_read_error = true;
+            }
+        }
+    }
+}
+
+bool CompiledGameSerializer::read_game(CompiledGame& p_game)
+{
+    CompiledGame::PreludeInfo& prelude = p_game.prelude_info;
+    for(optional<string>* info : {&prelude.title, &prelude.author, &prelude.homepage})
+    {
+        bool has_value = read_value<uint8_t>() != 0;
+        string value = read_string();
+        if(has_value)
+        {
+            *info = std::move(value);
+        }
+    }
+    bool has_realtime_interval = read_value<uint8_t>() != 0;
+    float realtime_interval = read_value<float>();
+    if(has_realtime_interval)
+    {
+        prelude.realtime_interval = realtime_interval;
+    }
+
+    //the objects are all created before their references are resolved since they can reference objects written after them
+    uint32_t primary_object_count = read_value<uint32_t>();
+    uint32_t object_count = read_count(1);
+    if(primary_object_count > object_count || primary_object_count > CompiledGame::MAX_PRIMARY_OBJECT_COUNT)
+    {
+        return false;
+    }
+    m_read_primary_object_count = (int)primary_object_count;
+
+    struct ObjectReferences
+    {
+        shared_ptr<CompiledGame::Object> object;
+        vector<int32_t> referenced_indexes;
+    };
+    vector<ObjectReferences> object_references;
+
+    m_read_objects.clear();
+    for(uint32_t i = 0; i < object_count && !m_has_read_error; ++i)
+    {
+        SerializedObjectType type = read_value<SerializedObjectType>();
+        if((type == SerializedObjectType::Primary) != (i < primary_object_count))
+        {
+            return false;
+        }
+
+        string identifier = read_string();
+        switch(type)
+        {
+        case SerializedObjectType::Primary:
+            {
+                shared_ptr<CompiledGame::PrimaryObject> obj(new CompiledGame::PrimaryObject(identifier));
+                obj->id = (int)i;
+                obj->collision_layer_id = read_value<int32_t>();
+                p_game.primary_objects.push_back(obj);
+                m_read_objects.push_back(obj);
+            }
+            break;
+        case SerializedObjectType::Alias:
+            {
+                shared_ptr<CompiledGame::AliasObject> obj(new CompiledGame::AliasObject(identifier, weak_ptr<CompiledGame::Object>()));
+                object_references.push_back({obj, {read_value<int32_t>()}});
+                m_read_objects.push_back(obj);
+            }
+            break;
+        case SerializedObjectType::Aggregate:
+        case SerializedObjectType::Properties:
+            {
+                shared_ptr<CompiledGame::GroupObject> obj;
+                if(type == SerializedObjectType::Aggregate)
+                {
+                    obj.reset(new CompiledGame::AggregateObject(identifier));
+                }
+                else
+                {
+                    obj.reset(new CompiledGame::PropertiesObject(identifier));
+                }
+
+                ObjectReferences references{obj, {}};
+                references.referenced_indexes.resize(read_count(sizeof(int32_t)));
+                for(int32_t& index : references.referenced_indexes)
+                {
+                    index = read_value<int32_t>();
+                }
+                object_references.push_back(std::move(references));
+                m_read_objects.push_back(obj);
+            }
+            break;
+        default:
+            return false;
+        }
+        p_game.objects.insert(m_read_objects.back());
+    }
+
+    for(const ObjectReferences& references : object_references)
+    {
+        vector<weak_ptr<CompiledGame::Object>> referenced_objects;
+        for(int32_t index : references.referenced_indexes)
+        {
+            if(index < 0 || index >= m_read_objects.size())
+            {
+                return false;
+            }
+            referenced_objects.push_back(m_read_objects[index]);
+        }
+
+        if(shared_ptr<CompiledGame::AliasObject> alias_obj = references.object->as_alias_object())
+        {
+            alias_obj->referenced_object = referenced_objects.front();
+        }
+        else
+        {
+            static_pointer_cast<CompiledGame::GroupObject>(references.object)->referenced_objects = std::move(referenced_objects);
+        }
+    }
+
+    p_game.player_object = read_object();
+
+    p_game.collision_layers.resize(read_count(1));
+    for(int i = 0; i < p_game.collision_layers.size(); ++i)
+    {
+        shared_ptr<CompiledGame::CollisionLayer> col_layer = make_shared<CompiledGame::CollisionLayer>();
+        p_game.collision_layers[i] = col_layer;
+
+        col_layer->objects.resize(read_count(sizeof(int32_t)));
+        for(weak_ptr<CompiledGame::PrimaryObject>& layer_obj : col_layer->objects)
+        {
+            shared_ptr<CompiledGame::PrimaryObject> obj = read_primary_object();
+            if(obj == nullptr)
+            {
+                return false;
+            }
+            obj->collision_layer = col_layer;
+            layer_obj = obj;
+        }
+    }
+
+    //the objects without a collision layer are on the extra one that follows the others
+    for(const shared_ptr<CompiledGame::PrimaryObject>& obj : p_game.primary_objects)
+    {
+        if(obj->collision_layer_id < 0 || obj->collision_layer_id > p_game.collision_layers.size())
+        {
+            return false;
+        }
+    }
+
+    uint32_t graphics_data_count = read_count(1);
+    for(uint32_t i = 0; i < graphics_data_count; ++i)
+    {
+        shared_ptr<CompiledGame::PrimaryObject> obj = read_primary_object();
+        CompiledGame::ObjectGraphicData& graphic_data = p_game.graphics_data[obj];
+
+        graphic_data.colors.resize(read_count(1));
+        for(CompiledGame::Color& color : graphic_data.colors)
+        {
+            color.name = (CompiledGame::Color::ColorName)read_value<int32_t>();
+            color.hexcode = read_string();
+        }
+
+        graphic_data.pixels.resize(read_count(sizeof(int32_t)));
+        for(int& pixel : graphic_data.pixels)
+        {
+            pixel = read_value<int32_t>();
+        }
+    }
+
+    read_rules(p_game.rules);
+    read_rules(p_game.late_rules);
+
+    p_game.win_conditions.resize(read_count(1));
+    for(CompiledGame::WinCondition& win_condition : p_game.win_conditions)
+    {
+        win_condition.type = (CompiledGame::WinConditionType)read_value<int32_t>();
+        win_condition.object = read_object();
+        win_condition.on_object = read_object();
+    }
+
+    p_game.levels.resize(read_count(1));
+    for(CompiledGame::Level& level : p_game.levels)
+    {
+        level.width = read_value<int32_t>();
+        level.height = read_value<int32_t>();
+
+        level.cells.resize(read_count(sizeof(uint32_t)));
+        if(level.width < 0 || level.height < 0 || (int64_t)level.width*level.height != (int64_t)level.cells.size())
+        {
+            return false;
+        }
+        for(CompiledGame::Cell& cell : level.cells)
+        {
+            cell.object_ids.resize(read_count(sizeof(int32_t)));
+            for(int& object_id : cell.object_ids)
+            {
+                object_id = read_value<int32_t>();
+                if(object_id < 0 || object_id >= p_game.primary_objects.size())
+                {
+                    return false;
+                }
+                cell.objects.push_back(p_game.primary_objects[object_id]);
+            }
+        }
+    }
+
+    p_game.levels_messages.resize(read_count(1));
+    for(vector<string>& messages : p_game.levels_messages)
+    {
+        messages.resize(read_count(sizeof(uint32_t)));
+        for(string& message : messages)
+        {
+            message = read_string();
+        }
+    }
+
+    return !m_has_read_error && m_cursor == m_end;
+}
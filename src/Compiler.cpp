@@ -1,5 +1,6 @@
 #include <vector>
 #include <algorithm>
+#include <cctype>
 #include <assert.h>
 
 #include "Compiler.hpp"
@@ -18,8 +19,9 @@ Compiler::Compiler(shared_ptr<PSLogger> p_logger) : m_logger(p_logger)
 std::optional<CompiledGame> Compiler::compile_game(const ParsedGame& p_parsed_game)
 {
     m_compiled_game = CompiledGame();
+    m_objects_by_id.clear();
 
-    m_logger->log(PSLogger::LogType::Log, m_compiler_log_cat, "Compiling");
+    PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_compiler_log_cat, "Compiling");
 
     compile_prelude(p_parsed_game.prelude_tokens);
     compile_objects(p_parsed_game.objects_tokens);
@@ -38,7 +40,10 @@ std::optional<CompiledGame> Compiler::compile_game(const ParsedGame& p_parsed_ga
     verify_rules_and_compute_deltas(m_compiled_game.rules);
     verify_rules_and_compute_deltas(m_compiled_game.late_rules);
 
-    m_logger->log(PSLogger::LogType::Log, m_compiler_log_cat, "Finished compiling");
+    compile_cell_rules_masks(m_compiled_game.rules);
+    compile_cell_rules_masks(m_compiled_game.late_rules);
+
+    PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_compiler_log_cat, "Finished compiling");
 
     return m_has_error ? nullopt : std::optional<CompiledGame>(m_compiled_game);
 }
@@ -72,16 +77,7 @@ bool Compiler::retrieve_player_object()
 
 bool Compiler::retrieve_background_objects()
 {
-    ci_equal case_unsensitive_equal;
-
-    for(shared_ptr<CompiledGame::Object> obj : m_compiled_game.objects)
-    {
-        if(case_unsensitive_equal(obj->identifier,"Background"))
-        {
-            m_background_object = obj;
-            break;
-        }
-    }
+    m_background_object = get_obj_by_id("Background");
 
     if(m_background_object.lock() == nullptr)
     {
@@ -104,7 +100,7 @@ bool Compiler::retrieve_background_objects()
 
 void Compiler::compile_prelude(const vector<Token<ParsedGame::PreludeTokenType>>& p_prelude_tokens)
 {
-    m_logger->log(PSLogger::LogType::Log, m_compiler_log_cat, "Compiling Prelude");
+    PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_compiler_log_cat, "Compiling Prelude");
 
     ParsedGame::PreludeTokenType last_token = ParsedGame::PreludeTokenType::None;
 
@@ -130,31 +126,31 @@ void Compiler::compile_prelude(const vector<Token<ParsedGame::PreludeTokenType>>
         case ParsedGame::PreludeTokenType::Literal:
             if(last_token == ParsedGame::PreludeTokenType::None)
             {
-                detect_error(token,"Unexpected literal "+ token.str_value + " here.");
+                detect_error(token,"Unexpected literal "+ string(token.str_value) + " here.");
                 continue;
             }
 
             if(last_token == ParsedGame::PreludeTokenType::Title)
             {
-                m_compiled_game.prelude_info.title = token.str_value;
+                m_compiled_game.prelude_info.title = string(token.str_value);
             }
             else if(last_token == ParsedGame::PreludeTokenType::Author)
             {
-                m_compiled_game.prelude_info.author = token.str_value;
+                m_compiled_game.prelude_info.author = string(token.str_value);
             }
             else if(last_token == ParsedGame::PreludeTokenType::Homepage)
             {
-                m_compiled_game.prelude_info.homepage = token.str_value;
+                m_compiled_game.prelude_info.homepage = string(token.str_value);
             }
             else if(last_token == ParsedGame::PreludeTokenType::RealtimeInterval)
             {
                 try
                 {
-                    m_compiled_game.prelude_info.realtime_interval = stof(token.str_value);
+                    m_compiled_game.prelude_info.realtime_interval = stof(string(token.str_value));
                 }
                 catch(const std::exception& e)
                 {
-                   detect_error(token, "was expecting a float value after realtime_interval but found \"" +token.str_value+ "\".");
+                   detect_error(token, "was expecting a float value after realtime_interval but found \"" +string(token.str_value)+ "\".");
                 }
             }
             else
@@ -169,12 +165,12 @@ void Compiler::compile_prelude(const vector<Token<ParsedGame::PreludeTokenType>>
 
         case ParsedGame::PreludeTokenType::None:
         default:
-            detect_error(token,"Unexpected prelude token ("+enum_to_str(token.token_type, ParsedGame::to_prelude_token_type).value_or("ERROR")+":"+ token.str_value +").");
+            detect_error(token,"Unexpected prelude token ("+enum_to_str(token.token_type, ParsedGame::to_prelude_token_type).value_or("ERROR")+":"+ string(token.str_value) +").");
             break;
         }
     }
 
-    m_logger->log(PSLogger::LogType::Log, m_compiler_log_cat, "Finished Compiling Prelude");
+    PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_compiler_log_cat, "Finished Compiling Prelude");
 }
 
 
@@ -190,7 +186,7 @@ void Compiler::compile_objects(const vector<Token<ParsedGame::ObjectsTokenType>>
 
     const int PIXEL_NUMBER = 25;
 
-    m_logger->log(PSLogger::LogType::Log, m_compiler_log_cat, "Compiling Objects");
+    PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_compiler_log_cat, "Compiling Objects");
 
     ObjectCompilingState state = ObjectCompilingState::WaitingForIdentifier;
 
@@ -210,8 +206,16 @@ void Compiler::compile_objects(const vector<Token<ParsedGame::ObjectsTokenType>>
                         break;
                     }
 
-                    shared_ptr<CompiledGame::PrimaryObject> obj( new CompiledGame::PrimaryObject(token.str_value));
-                    m_compiled_game.objects.insert(obj);
+                    if(m_compiled_game.primary_objects.size() >= CompiledGame::MAX_PRIMARY_OBJECT_COUNT)
+                    {
+                        detect_error(token, "too many objects, a game cannot have more than " + to_string(CompiledGame::MAX_PRIMARY_OBJECT_COUNT) + " of them");
+                        break;
+                    }
+
+                    shared_ptr<CompiledGame::PrimaryObject> obj( new CompiledGame::PrimaryObject(string(token.str_value)));
+                    obj->id = (int)m_compiled_game.primary_objects.size();
+                    m_compiled_game.primary_objects.push_back(obj);
+                    declare_object(obj);
                     last_object = obj;
                     state = ObjectCompilingState::WaitingForColor;
                 }
@@ -227,7 +231,7 @@ void Compiler::compile_objects(const vector<Token<ParsedGame::ObjectsTokenType>>
                 if(token.token_type == ParsedGame::ObjectsTokenType::ColorHexCode)
                 {
                     CompiledGame::Color color;
-                    color.hexcode = token.str_value;
+                    color.hexcode = string(token.str_value);
                     state = ObjectCompilingState::WaitingForColorOrPixelOrIdentifier;
                     graphic_data.colors.push_back(color);
                 }
@@ -254,7 +258,7 @@ void Compiler::compile_objects(const vector<Token<ParsedGame::ObjectsTokenType>>
                 if(token.token_type == ParsedGame::ObjectsTokenType::ColorHexCode)
                 {
                     CompiledGame::Color color;
-                    color.hexcode = token.str_value;
+                    color.hexcode = string(token.str_value);
                     state = ObjectCompilingState::WaitingForColorOrPixelOrIdentifier;
                     graphic_data.colors.push_back(color);
                 }
@@ -288,8 +292,16 @@ void Compiler::compile_objects(const vector<Token<ParsedGame::ObjectsTokenType>>
                         break;
                     }
 
-                    shared_ptr<CompiledGame::PrimaryObject> obj( new CompiledGame::PrimaryObject(token.str_value));
-                    m_compiled_game.objects.insert(obj);
+                    if(m_compiled_game.primary_objects.size() >= CompiledGame::MAX_PRIMARY_OBJECT_COUNT)
+                    {
+                        detect_error(token, "too many objects, a game cannot have more than " + to_string(CompiledGame::MAX_PRIMARY_OBJECT_COUNT) + " of them");
+                        break;
+                    }
+
+                    shared_ptr<CompiledGame::PrimaryObject> obj( new CompiledGame::PrimaryObject(string(token.str_value)));
+                    obj->id = (int)m_compiled_game.primary_objects.size();
+                    m_compiled_game.primary_objects.push_back(obj);
+                    declare_object(obj);
                     last_object = obj;
                     state = ObjectCompilingState::WaitingForColor;
 
@@ -305,7 +317,7 @@ void Compiler::compile_objects(const vector<Token<ParsedGame::ObjectsTokenType>>
                         int pixel_value = -1;
                         try
                         {
-                            pixel_value = stoi(token.str_value);
+                            pixel_value = stoi(string(token.str_value));
                         }
                         catch(...)
                         {
@@ -336,7 +348,7 @@ void Compiler::compile_objects(const vector<Token<ParsedGame::ObjectsTokenType>>
                         int pixel_value = -1;
                         try
                         {
-                            pixel_value = stoi(token.str_value);
+                            pixel_value = stoi(string(token.str_value));
                         }
                         catch(...)
                         {
@@ -368,7 +380,7 @@ void Compiler::compile_objects(const vector<Token<ParsedGame::ObjectsTokenType>>
         }
     }
 
-    m_logger->log(PSLogger::LogType::Log, m_compiler_log_cat, "Finished Compiling Objects");
+    PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_compiler_log_cat, "Finished Compiling Objects");
 }
 
 
@@ -390,7 +402,7 @@ void Compiler::compile_legend(const vector<Token<ParsedGame::LegendTokenType>>&
 
     LegendCompilationState compilation_state = LegendCompilationState::WaitingForIdentifier;
 
-    m_logger->log(PSLogger::LogType::Log, m_compiler_log_cat, "Compiling Legend");
+    PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_compiler_log_cat, "Compiling Legend");
 
     string current_identifier = "";
     vector<weak_ptr<CompiledGame::Object>> current_obj_refs;
@@ -415,7 +427,7 @@ void Compiler::compile_legend(const vector<Token<ParsedGame::LegendTokenType>>&
                 {
                     if(check_identifier_validity(token.str_value, token.token_line, false))
                     {
-                        current_identifier = token.str_value;
+                        current_identifier = string(token.str_value);
                         compilation_state = LegendCompilationState::WaitingForEqual;
                     }
                 }
@@ -461,7 +473,7 @@ void Compiler::compile_legend(const vector<Token<ParsedGame::LegendTokenType>>&
                     case ObjectGroupType::None:
                         {
                             shared_ptr<CompiledGame::AliasObject> obj( new CompiledGame::AliasObject(current_identifier,current_obj_refs.front()));
-                            m_compiled_game.objects.insert(obj);
+                            declare_object(obj);
                         }
                         break;
                     case ObjectGroupType::Or:
@@ -476,7 +488,7 @@ void Compiler::compile_legend(const vector<Token<ParsedGame::LegendTokenType>>&
                                 }
                                 obj->referenced_objects.push_back(ref_obj);
                             }
-                            m_compiled_game.objects.insert(obj);
+                            declare_object(obj);
                         }
                         break;
                     case ObjectGroupType::And:
@@ -491,7 +503,7 @@ void Compiler::compile_legend(const vector<Token<ParsedGame::LegendTokenType>>&
                                 }
                                 obj->referenced_objects.push_back(ref_obj);
                             }
-                            m_compiled_game.objects.insert(obj);
+                            declare_object(obj);
                         }
                         break;
 
@@ -540,14 +552,14 @@ void Compiler::compile_legend(const vector<Token<ParsedGame::LegendTokenType>>&
             break;
         }
     }
-    m_logger->log(PSLogger::LogType::Log, m_compiler_log_cat, "Finished Compiling Legend");
+    PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_compiler_log_cat, "Finished Compiling Legend");
 }
 
 void Compiler::compile_collision_layers(const vector<Token<ParsedGame::CollisionLayersTokenType>>& p_collision_layer_tokens)
 {
     shared_ptr<CompiledGame::CollisionLayer> current_collision_layer( new CompiledGame::CollisionLayer());
 
-    m_logger->log(PSLogger::LogType::Log, m_compiler_log_cat, "Compiling Collision Layers");
+    PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_compiler_log_cat, "Compiling Collision Layers");
 
     for(auto& token : p_collision_layer_tokens)
     {
@@ -598,12 +610,12 @@ void Compiler::compile_collision_layers(const vector<Token<ParsedGame::Collision
             break;
         }
     }
-    m_logger->log(PSLogger::LogType::Log, m_compiler_log_cat, "Finished Compiling Collision Layers");
+    PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_compiler_log_cat, "Finished Compiling Collision Layers");
 }
 
 void Compiler::compile_rules(const vector<Token<ParsedGame::RulesTokenType>>& p_rules_tokens)
 {
-    m_logger->log(PSLogger::LogType::Log, m_compiler_log_cat, "Compiling Rules");
+    PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_compiler_log_cat, "Compiling Rules");
 
     typedef ParsedGame::RulesTokenType RulesToken;
     static const vector<RulesToken> commands = {
@@ -1027,7 +1039,7 @@ void Compiler::compile_rules(const vector<Token<ParsedGame::RulesTokenType>>& p_
 
                 if(token.token_type == RulesToken::MessageContent)
                 {
-                    command.message = token.str_value;
+                    command.message = string(token.str_value);
                     state = RuleCompilingState::WaitingForReturn;
                 }
                 else if(token.token_type == RulesToken::Return)
@@ -1057,12 +1069,12 @@ void Compiler::compile_rules(const vector<Token<ParsedGame::RulesTokenType>>& p_
         }
 
     }
-    m_logger->log(PSLogger::LogType::Log, m_compiler_log_cat, "Finished Compiling Rules");
+    PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_compiler_log_cat, "Finished Compiling Rules");
 }
 
 void Compiler::compile_win_conditions(const vector<Token<ParsedGame::WinConditionsTokenType>>& p_win_conditions_tokens)
 {
-    m_logger->log(PSLogger::LogType::Log, m_compiler_log_cat, "Compiling win conditions");
+    PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_compiler_log_cat, "Compiling win conditions");
 
     //todo this compiler function does not yet enforce strict tokens ordering
 
@@ -1151,12 +1163,12 @@ void Compiler::compile_win_conditions(const vector<Token<ParsedGame::WinConditio
             break;
         }
     }
-    m_logger->log(PSLogger::LogType::Log, m_compiler_log_cat, "Finished Compiling win conditions");
+    PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_compiler_log_cat, "Finished Compiling win conditions");
 }
 
 void Compiler::compile_levels(const vector<Token<ParsedGame::LevelsTokenType>>& p_levels_tokens)
 {
-    m_logger->log(PSLogger::LogType::Log, m_compiler_log_cat, "Compiling Levels");
+    PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_compiler_log_cat, "Compiling Levels");
 
     CompiledGame::Level current_level;
 
@@ -1179,7 +1191,7 @@ void Compiler::compile_levels(const vector<Token<ParsedGame::LevelsTokenType>>&
         {
             if(token.token_type == ParsedGame::LevelsTokenType::MessageContent)
             {
-                m_compiled_game.levels_messages.back().push_back(token.str_value);
+                m_compiled_game.levels_messages.back().push_back(string(token.str_value));
             }
             else if(token.token_type == ParsedGame::LevelsTokenType::Return)
             {
@@ -1264,6 +1276,11 @@ void Compiler::compile_levels(const vector<Token<ParsedGame::LevelsTokenType>>&
                         current_level.cells.back().objects.push_back(m_default_background_object);
                     }
 
+                    for(const weak_ptr<CompiledGame::PrimaryObject>& prim_obj : current_level.cells.back().objects)
+                    {
+                        current_level.cells.back().object_ids.push_back(prim_obj.lock()->id);
+                    }
+
                     ++current_tiles_number_on_row;
                 }
                 break;
@@ -1280,26 +1297,54 @@ void Compiler::compile_levels(const vector<Token<ParsedGame::LevelsTokenType>>&
     }
 
     //Adding the level or the message here in case there was no return token after the last level or last message
+    if(current_tiles_number_on_row != 0)
+    {
+        //the last line of the level had no return token either
+        if(compiling_level_first_line)
+        {
+            compiling_level_first_line = false;
+            current_level.width = current_tiles_number_on_row;
+        }
+        else if(current_tiles_number_on_row != current_level.width)
+        {
+            detect_error(p_levels_tokens.back(), "levels must be rectangular, this line does not match the width of the first one.");
+        }
+        ++current_height;
+    }
+
     if(compiling_level_first_line == false)
     {
         current_level.height = current_height;
         m_compiled_game.levels.push_back(current_level);
+
+        m_compiled_game.levels_messages.push_back(vector<string>());
     }
     else if( waiting_for_message_content_or_return)
     {
         m_compiled_game.levels_messages.back().push_back("");
     }
 
-    m_logger->log(PSLogger::LogType::Log, m_compiler_log_cat, "Finished Compiling Levels");
+    PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_compiler_log_cat, "Finished Compiling Levels");
 }
 
 void Compiler::reference_collision_layers_in_objects()
 {
-    for(shared_ptr<CompiledGame::CollisionLayer> col_layer : m_compiled_game.collision_layers)
+    for(int i = 0; i < m_compiled_game.collision_layers.size(); ++i)
     {
+        shared_ptr<CompiledGame::CollisionLayer> col_layer = m_compiled_game.collision_layers[i];
         for(weak_ptr<CompiledGame::PrimaryObject> obj : col_layer->objects)
         {
             obj.lock()->collision_layer = col_layer;
+            obj.lock()->collision_layer_id = i;
+        }
+    }
+
+    //objects that were not put on a collision layer all share an extra one, they used to collide with each other through their null layer
+    for(const auto& obj : m_compiled_game.primary_objects)
+    {
+        if(obj->collision_layer_id == -1)
+        {
+            obj->collision_layer_id = (int)m_compiled_game.collision_layers.size();
         }
     }
 }
@@ -1511,20 +1556,104 @@ void Compiler::verify_rules_and_compute_deltas(vector<CompiledGame::Rule>& p_rul
     }
 }
 
-weak_ptr<CompiledGame::Object> Compiler::get_obj_by_id(const string& p_id)
+void Compiler::compile_cell_rules_masks(vector<CompiledGame::Rule>& p_rules)
+{
+    const int mask_word_count = m_compiled_game.get_object_mask_word_count();
+
+    for(CompiledGame::Rule& rule : p_rules)
+    {
+        for(CompiledGame::Pattern& pattern : rule.match_patterns)
+        {
+            for(CompiledGame::CellRule& cell_rule : pattern.cells)
+            {
+                cell_rule.required_objects = CompiledGame::ObjectMask(mask_word_count);
+                cell_rule.forbidden_objects = CompiledGame::ObjectMask(mask_word_count);
+
+                for(const auto& content_pair : cell_rule.content)
+                {
+                    const shared_ptr<CompiledGame::Object>& obj = content_pair.first;
+                    CompiledGame::ObjectMask obj_mask = m_compiled_game.get_object_mask(obj);
+
+                    if(content_pair.second == CompiledGame::EntityRuleInfo::No)
+                    {
+                        //an aggregate has an empty mask so "no aggregate" is always true, as it was with AggregateObject::defines
+                        for(int w = 0; w < mask_word_count; ++w)
+                        {
+                            cell_rule.forbidden_objects.words[w] |= obj_mask.words[w];
+                        }
+                        continue;
+                    }
+
+                    if(obj->is_aggregate())
+                    {
+                        cell_rule.can_never_match = true;
+                        continue;
+                    }
+
+                    CompiledGame::CellRule::MovementRequirement movement_requirement;
+                    movement_requirement.rule_info = content_pair.second;
+
+                    if(obj->is_properties())
+                    {
+                        movement_requirement.any_of_index = (int)cell_rule.any_of_objects.size();
+                        cell_rule.any_of_objects.push_back(obj_mask);
+                    }
+                    else
+                    {
+                        vector<weak_ptr<CompiledGame::PrimaryObject>> prim_objs;
+                        obj->GetAllPrimaryObjects(prim_objs);
+                        assert(prim_objs.size() == 1);
+
+                        movement_requirement.object_id = prim_objs[0].lock()->id;
+                        cell_rule.required_objects.set(movement_requirement.object_id);
+                    }
+
+                    if(movement_requirement.rule_info != CompiledGame::EntityRuleInfo::None)
+                    {
+                        cell_rule.movement_requirements.push_back(movement_requirement);
+                    }
+                }
+            }
+        }
+
+        for(CompiledGame::Delta& delta : rule.deltas)
+        {
+            if(delta.object->as_primary_object() != nullptr)
+            {
+                delta.primary_object_id = delta.object->as_primary_object()->id;
+            }
+            delta.object_mask = m_compiled_game.get_object_mask(delta.object);
+        }
+    }
+}
+
+void Compiler::declare_object(shared_ptr<CompiledGame::Object> p_obj)
+{
+    m_compiled_game.objects.insert(p_obj);
+    m_objects_by_id[string(get_id_lookup_key(p_obj->identifier))] = p_obj;
+}
+
+const string& Compiler::get_id_lookup_key(string_view p_id)
+{
+    m_id_lookup_key.assign(p_id);
+    for(char& c : m_id_lookup_key)
+    {
+        c = (char)tolower((unsigned char)c);
+    }
+    return m_id_lookup_key;
+}
+
+weak_ptr<CompiledGame::Object> Compiler::get_obj_by_id(string_view p_id)
 {
-    ci_equal comp_equal;
-    auto found_existing_object = std::find_if(m_compiled_game.objects.begin(),m_compiled_game.objects.end(),[&](shared_ptr<CompiledGame::Object> obj){
-        return comp_equal(obj->identifier, p_id);
-    });
-    if(found_existing_object != m_compiled_game.objects.end() )
+    auto found_existing_object = m_objects_by_id.find(get_id_lookup_key(p_id));
+    if(found_existing_object != m_objects_by_id.end() )
     {
-        return *found_existing_object;
+        return found_existing_object->second;
     }
     return std::weak_ptr<CompiledGame::Object>();
 }
 
-bool Compiler::check_identifier_validity(const string& p_id, int p_identifier_line_numbler, bool p_should_already_exist)
+bool Compiler::check_identifier_validity(string_view p_id, int p_identifier_line_numbler, bool p_should_already_exist)
 {
     if(p_id.empty())
     {
@@ -1533,18 +1662,15 @@ bool Compiler::check_identifier_validity(const string& p_id, int p_identifier_li
     }
 
     //find if objects was already declared
-    ci_equal comp_equal;
-    auto found_existing_object = std::find_if(m_compiled_game.objects.begin(),m_compiled_game.objects.end(),[&](shared_ptr<CompiledGame::Object> obj){
-        return comp_equal(obj->identifier, p_id);
-    });
-    if(found_existing_object != m_compiled_game.objects.end() && !p_should_already_exist)
+    bool is_already_declared = m_objects_by_id.find(get_id_lookup_key(p_id)) != m_objects_by_id.end();
+    if(is_already_declared && !p_should_already_exist)
     {
         detect_error(p_identifier_line_numbler,"Another object is already called like that !");
         return false;
     }
-    else if(found_existing_object == m_compiled_game.objects.end() && p_should_already_exist)
+    else if(!is_already_declared && p_should_already_exist)
     {
-        detect_error(p_identifier_line_numbler,"trying to reference Object \"" + p_id + "\" but it does not exists !");
+        detect_error(p_identifier_line_numbler,"trying to reference Object \"" + string(p_id) + "\" but it does not exists !");
         return false;
     }
 
@@ -1552,20 +1678,20 @@ bool Compiler::check_identifier_validity(const string& p_id, int p_identifier_li
 }
 
 template<typename T>
-void Compiler::detect_error(Token<T> p_token, string p_error_msg, bool p_is_warning /*= false*/)
+void Compiler::detect_error(const Token<T>& p_token, const string& p_error_msg, bool p_is_warning /*= false*/)
 {
     if(!p_is_warning)
     {
         m_has_error = true;
     }
-    m_logger->log(p_is_warning ? PSLogger::LogType::Warning : PSLogger::LogType::Error, m_compiler_log_cat, "(l." + to_string(p_token.token_line) + ") : " + p_error_msg);
+    PS_LOGGER_LOG(m_logger, p_is_warning ? PSLogger::LogType::Warning : PSLogger::LogType::Error, m_compiler_log_cat, "(l." + to_string(p_token.token_line) + ") : " + p_error_msg);
 }
 
-void Compiler::detect_error(int p_line_number, string p_error_msg, bool p_is_warning /*= false*/)
+void Compiler::detect_error(int p_line_number, const string& p_error_msg, bool p_is_warning /*= false*/)
 {
     if(!p_is_warning)
     {
         m_has_error = true;
     }
-    m_logger->log(p_is_warning ? PSLogger::LogType::Warning : PSLogger::LogType::Error, m_compiler_log_cat, "(l." + to_string(p_line_number) + ") : " + p_error_msg);
+    PS_LOGGER_LOG(m_logger, p_is_warning ? PSLogger::LogType::Warning : PSLogger::LogType::Error, m_compiler_log_cat, "(l." + to_string(p_line_number) + ") : " + p_error_msg);
 }
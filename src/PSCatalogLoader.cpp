@@ -0,0 +1,109 @@
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+
+#include "PSCatalogLoader.hpp"
+#include "Parser.hpp"
+#include "Compiler.hpp"
+
+using namespace std;
+
+void PSCatalogLoader::RecordingLogger::log(LogType p_type, const std::string& p_category, const std::string& p_msg)
+{
+    if(!is_enabled(p_type))
+    {
+        return;
+    }
+
+    diagnostics.push_back({p_type, p_category, p_msg});
+}
+
+map<string, PSCatalogLoader::LoadedGame> PSCatalogLoader::load_games(const vector<string>& p_file_paths)
+{
+    return load_games(p_file_paths, Config());
+}
+
+map<string, PSCatalogLoader::LoadedGame> PSCatalogLoader::load_games(const vector<string>& p_file_paths, Config p_config)
+{
+    vector<string> file_paths = p_file_paths;
+    std::sort(file_paths.begin(), file_paths.end());
+    file_paths.erase(std::unique(file_paths.begin(), file_paths.end()), file_paths.end());
+
+    int thread_count = p_config.thread_count > 0 ? p_config.thread_count : std::max(1, (int)std::thread::hardware_concurrency());
+    thread_count = std::max(1, std::min(thread_count, (int)file_paths.size()));
+
+    //every thread takes the next game not yet loaded until there is none left
+    vector<LoadedGame> loaded_games(file_paths.size());
+    std::atomic<size_t> next_game_idx{0};
+    auto load_next_games = [&]()
+    {
+        for(size_t game_idx = next_game_idx++; game_idx < file_paths.size(); game_idx = next_game_idx++)
+        {
+            loaded_games[game_idx] = load_game(file_paths[game_idx], p_config);
+        }
+    };
+
+    //the calling thread is the first worker
+    vector<std::thread> threads;
+    for(int i = 1; i < thread_count; ++i)
+    {
+        threads.emplace_back(load_next_games);
+    }
+    load_next_games();
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    map<string, LoadedGame> result;
+    for(size_t i = 0; i < file_paths.size(); ++i)
+    {
+        result[file_paths[i]] = std::move(loaded_games[i]);
+    }
+    return result;
+}
+
+PSCatalogLoader::LoadedGame PSCatalogLoader::load_game(const string& p_file_path, const Config& p_config)
+{
+    auto start_time = std::chrono::steady_clock::now();
+
+    shared_ptr<RecordingLogger> logger = make_shared<RecordingLogger>();
+    logger->log_verbosity = p_config.log_verbosity;
+
+    LoadedGame loaded_game;
+
+    optional<ParsedGame> parsed_game = Parser::parse_from_file(p_file_path, logger);
+    if(parsed_game.has_value())
+    {
+        Compiler compiler(logger);
+        optional<CompiledGame> compiled_game = compiler.compile_game(parsed_game.value());
+        if(compiled_game.has_value())
+        {
+            loaded_game.compiled_game = make_shared<const CompiledGame>(std::move(compiled_game.value()));
+        }
+    }
+
+    loaded_game.diagnostics = std::move(logger->diagnostics);
+    loaded_game.duration_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count();
+    return loaded_game;
+}
+
+vector<string> PSCatalogLoader::find_game_files(const string& p_directory_path, const string& p_extension /*= ".txt"*/)
+{
+    ci_equal equal_op;
+
+    vector<string> file_paths;
+    std::error_code error;
+    for(const auto& entry : std::filesystem::directory_iterator(p_directory_path, error))
+    {
+        if(entry.is_regular_file() && equal_op(entry.path().extension().string(), p_extension))
+        {
+            file_paths.push_back(entry.path().string());
+        }
+    }
+
+    std::sort(file_paths.begin(), file_paths.end());
+    return file_paths;
+}
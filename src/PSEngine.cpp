@@ -1,6 +1,9 @@
 
 #include <iostream>
 #include <vector>
+#include <array>
+#include <algorithm>
+#include <chrono>
 #include <functional>
 #include <assert.h>
 
@@ -8,6 +11,11 @@
 
 using namespace std;
 
+static uint64_t get_time_ns()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 
 const string PSEngine::m_engine_log_cat = "engine";
 
@@ -48,71 +56,265 @@ std::map<string,PSEngine::OperationType, ci_less> PSEngine::to_operation_type ={
     {"LoadGame", OperationType::LoadGame},
 };
 
-vector<CompiledGame::Command> PSEngine::SubturnHistory::gather_all_subturn_commands() const
+//the absolute move matching a relative one when a rule is applied in a direction, indexed by [AbsoluteDirection][relative up, down, left, right]
+static constexpr PSEngine::ObjectMoveType relative_move_types_table[PSEngine::ABSOLUTE_DIRECTION_COUNT][4] = {
+    /*None*/  {PSEngine::ObjectMoveType::None, PSEngine::ObjectMoveType::None, PSEngine::ObjectMoveType::None, PSEngine::ObjectMoveType::None},
+    /*Up*/    {PSEngine::ObjectMoveType::Left, PSEngine::ObjectMoveType::Right, PSEngine::ObjectMoveType::Down, PSEngine::ObjectMoveType::Up},
+    /*Down*/  {PSEngine::ObjectMoveType::Right, PSEngine::ObjectMoveType::Left, PSEngine::ObjectMoveType::Up, PSEngine::ObjectMoveType::Down},
+    /*Left*/  {PSEngine::ObjectMoveType::Down, PSEngine::ObjectMoveType::Up, PSEngine::ObjectMoveType::Right, PSEngine::ObjectMoveType::Left},
+    /*Right*/ {PSEngine::ObjectMoveType::Up, PSEngine::ObjectMoveType::Down, PSEngine::ObjectMoveType::Left, PSEngine::ObjectMoveType::Right},
+};
+
+static constexpr PSEngine::MoveTypeMask compute_allowed_move_types(CompiledGame::EntityRuleInfo p_rule_info, int p_rule_dir)
 {
-    vector<CompiledGame::Command> commands;
-    for( const auto& step : steps)
+    using Info = CompiledGame::EntityRuleInfo;
+    using Move = PSEngine::ObjectMoveType;
+    const auto& relative_moves = relative_move_types_table[p_rule_dir];
+
+    switch (p_rule_info)
     {
-        commands.insert(commands.end(), step.rule_applied.commands.begin(), step.rule_applied.commands.end());
+    case Info::None:
+        return PSEngine::ALL_MOVE_TYPES_MASK;
+    case Info::Stationary:
+        return PSEngine::move_type_bit(Move::Stationary);
+    case Info::Up:
+        return PSEngine::move_type_bit(Move::Up);
+    case Info::Down:
+        return PSEngine::move_type_bit(Move::Down);
+    case Info::Left:
+        return PSEngine::move_type_bit(Move::Left);
+    case Info::Right:
+        return PSEngine::move_type_bit(Move::Right);
+    case Info::Horizontal:
+        return PSEngine::move_type_bit(Move::Left) | PSEngine::move_type_bit(Move::Right);
+    case Info::Vertical:
+        return PSEngine::move_type_bit(Move::Up) | PSEngine::move_type_bit(Move::Down);
+    case Info::Orthogonal:
+        return PSEngine::move_type_bit(Move::Up) | PSEngine::move_type_bit(Move::Down) | PSEngine::move_type_bit(Move::Left) | PSEngine::move_type_bit(Move::Right);
+    case Info::Action:
+        return PSEngine::move_type_bit(Move::Action);
+    case Info::Moving:
+        return PSEngine::move_type_bit(Move::Up) | PSEngine::move_type_bit(Move::Down) | PSEngine::move_type_bit(Move::Left) | PSEngine::move_type_bit(Move::Right) | PSEngine::move_type_bit(Move::Action);
+    case Info::RelativeUp:
+        return PSEngine::move_type_bit(relative_moves[0]);
+    case Info::RelativeDown:
+        return PSEngine::move_type_bit(relative_moves[1]);
+    case Info::RelativeLeft:
+        return PSEngine::move_type_bit(relative_moves[2]);
+    case Info::RelativeRight:
+        return PSEngine::move_type_bit(relative_moves[3]);
+    case Info::Perpendicular:
+        return PSEngine::move_type_bit(relative_moves[0]) | PSEngine::move_type_bit(relative_moves[1]);
+    case Info::Parallel:
+        return PSEngine::move_type_bit(relative_moves[2]) | PSEngine::move_type_bit(relative_moves[3]);
+    default: //"no" is handled by the rule masks, it never matches a movement
+        return 0;
+    }
+}
+
+static constexpr auto build_allowed_move_types_table()
+{
+    array<array<PSEngine::MoveTypeMask, PSEngine::ABSOLUTE_DIRECTION_COUNT>, PSEngine::ENTITY_RULE_INFO_COUNT> table = {};
+    for(int info = 0; info < PSEngine::ENTITY_RULE_INFO_COUNT; ++info)
+    {
+        for(int dir = 0; dir < PSEngine::ABSOLUTE_DIRECTION_COUNT; ++dir)
+        {
+            table[info][dir] = compute_allowed_move_types((CompiledGame::EntityRuleInfo)info, dir);
+        }
     }
-    return commands;
+    return table;
 }
 
+//the ObjectMoveType bits an entity rule info accepts when a rule is applied in a direction, indexed by [EntityRuleInfo][AbsoluteDirection]
+static constexpr auto allowed_move_types_table = build_allowed_move_types_table();
+
+//the object delta and absolute direction matching each ObjectMoveType
+static constexpr CompiledGame::ObjectDeltaType move_type_to_delta_type_table[PSEngine::OBJECT_MOVE_TYPE_COUNT] = {
+    CompiledGame::ObjectDeltaType::None,
+    CompiledGame::ObjectDeltaType::Up,
+    CompiledGame::ObjectDeltaType::Down,
+    CompiledGame::ObjectDeltaType::Left,
+    CompiledGame::ObjectDeltaType::Right,
+    CompiledGame::ObjectDeltaType::Action,
+    CompiledGame::ObjectDeltaType::Stationary,
+};
+
+static constexpr PSEngine::AbsoluteDirection move_type_to_direction_table[PSEngine::OBJECT_MOVE_TYPE_COUNT] = {
+    PSEngine::AbsoluteDirection::None,
+    PSEngine::AbsoluteDirection::Up,
+    PSEngine::AbsoluteDirection::Down,
+    PSEngine::AbsoluteDirection::Left,
+    PSEngine::AbsoluteDirection::Right,
+    PSEngine::AbsoluteDirection::None,
+    PSEngine::AbsoluteDirection::None,
+};
+
+static constexpr PSEngine::AbsoluteDirection opposite_direction_table[PSEngine::ABSOLUTE_DIRECTION_COUNT] = {
+    PSEngine::AbsoluteDirection::None,
+    PSEngine::AbsoluteDirection::Down,
+    PSEngine::AbsoluteDirection::Up,
+    PSEngine::AbsoluteDirection::Right,
+    PSEngine::AbsoluteDirection::Left,
+};
+
+static const vector<PSEngine::AbsoluteDirection> all_absolute_directions = {PSEngine::AbsoluteDirection::Up, PSEngine::AbsoluteDirection::Down, PSEngine::AbsoluteDirection::Left, PSEngine::AbsoluteDirection::Right};
+static const vector<PSEngine::AbsoluteDirection> horizontal_absolute_directions = {PSEngine::AbsoluteDirection::Left, PSEngine::AbsoluteDirection::Right};
+static const vector<PSEngine::AbsoluteDirection> vertical_absolute_directions = {PSEngine::AbsoluteDirection::Up, PSEngine::AbsoluteDirection::Down};
+static const vector<PSEngine::AbsoluteDirection> up_absolute_direction = {PSEngine::AbsoluteDirection::Up};
+static const vector<PSEngine::AbsoluteDirection> down_absolute_direction = {PSEngine::AbsoluteDirection::Down};
+static const vector<PSEngine::AbsoluteDirection> left_absolute_direction = {PSEngine::AbsoluteDirection::Left};
+static const vector<PSEngine::AbsoluteDirection> right_absolute_direction = {PSEngine::AbsoluteDirection::Right};
+
 
-optional<shared_ptr<CompiledGame::PrimaryObject>> PSEngine::Cell::find_colliding_object(shared_ptr<CompiledGame::PrimaryObject> obj) const
+void PSEngine::Level::init(int p_level_idx, PSVector2i p_size, int p_object_count, int p_collision_layer_count)
 {
-    set<shared_ptr<CompiledGame::CollisionLayer>> current_col_layers;
+    level_idx = p_level_idx;
+    size = p_size;
 
-    current_col_layers.insert(obj->collision_layer.lock());
+    object_words_per_cell = (p_object_count + 63)/64;
+    movement_bytes_per_cell = (p_collision_layer_count + 1)/2;
 
-    for(auto& pair : objects )
+    position_words_per_object = (get_cell_count() + 63)/64;
+
+    objects.assign(get_cell_count()*object_words_per_cell, 0);
+    object_positions.assign(p_object_count*position_words_per_object, 0);
+
+    direction_strides[(int)AbsoluteDirection::Up] = -size.x;
+    direction_strides[(int)AbsoluteDirection::Down] = size.x;
+    direction_strides[(int)AbsoluteDirection::Left] = -1;
+    direction_strides[(int)AbsoluteDirection::Right] = 1;
+
+    distances_to_edge.assign(get_cell_count()*ABSOLUTE_DIRECTION_COUNT, 0);
+    for(int i = 0; i < get_cell_count(); ++i)
     {
-        if( current_col_layers.count(pair.first->collision_layer.lock()) != 0)
-        {
-            return optional<shared_ptr<CompiledGame::PrimaryObject>> ( pair.first ) ; //collision was detected;
-        }
-        current_col_layers.insert(pair.first->collision_layer.lock());
+        PSVector2i position = get_cell_position(i);
+        int* cell_distances = &distances_to_edge[i*ABSOLUTE_DIRECTION_COUNT];
+        cell_distances[(int)AbsoluteDirection::Up] = position.y;
+        cell_distances[(int)AbsoluteDirection::Down] = size.y - 1 - position.y;
+        cell_distances[(int)AbsoluteDirection::Left] = position.x;
+        cell_distances[(int)AbsoluteDirection::Right] = size.x - 1 - position.x;
     }
 
-    return nullopt;
+    state_hash = 0;
+    change_stamp = 1;
+    object_change_stamps.assign(p_object_count, 0);
+    movement_change_stamps.assign(p_collision_layer_count, 0);
+    //every layer starts stationary, a nibble pair of stationary movements
+    movements.assign(get_cell_count()*movement_bytes_per_cell, (uint8_t)(ObjectMoveType::Stationary | (ObjectMoveType::Stationary << 4)));
 }
 
-void PSEngine::ObjectCache::build_cache(const Level p_level)
+int PSEngine::Level::get_cell_index(PSVector2i p_position) const
 {
-    m_content.clear();
-    for(const auto& cell : p_level.cells )
+    //check for out of bounds
+    if(p_position.x >= size.x || p_position.x < 0 || p_position.y >= size.y || p_position.y < 0)
     {
-        for(const auto& pair : cell.objects)
+        return -1;
+    }
+
+    return p_position.x + p_position.y*size.x;
+}
+
+vector<int> PSEngine::Level::get_objects_in_cell(int p_cell_idx) const
+{
+    vector<int> result;
+    const uint64_t* cell_objects = get_cell_objects(p_cell_idx);
+    for(int w = 0; w < object_words_per_cell; ++w)
+    {
+        uint64_t bits = cell_objects[w];
+        while(bits != 0)
         {
-            add_object_position(pair.first, cell.position);
+            result.push_back(w*64 + pop_lowest_bit_index(bits));
         }
     }
+    return result;
 }
 
-void PSEngine::ObjectCache::add_object_position(const shared_ptr<CompiledGame::PrimaryObject> p_object,PSVector2i p_position)
+PSEngine::ObjectMoveType PSEngine::Level::get_movement(int p_cell_idx, int p_collision_layer) const
 {
-    m_content[p_object].insert(p_position);
+    uint8_t byte = movements[p_cell_idx*movement_bytes_per_cell + p_collision_layer/2];
+    return (ObjectMoveType)((p_collision_layer % 2 == 0) ? (byte & 0x0F) : (byte >> 4));
 }
 
-void PSEngine::ObjectCache::remove_object_position(const shared_ptr<CompiledGame::PrimaryObject> p_object,PSVector2i p_position)
+void PSEngine::Level::set_movement(int p_cell_idx, int p_collision_layer, ObjectMoveType p_move_type)
 {
-    m_content[p_object].erase(p_position);
+    uint8_t& byte = movements[p_cell_idx*movement_bytes_per_cell + p_collision_layer/2];
+    uint8_t new_byte = 0;
+    if(p_collision_layer % 2 == 0)
+    {
+        new_byte = (byte & 0xF0) | (uint8_t)p_move_type;
+    }
+    else
+    {
+        new_byte = (byte & 0x0F) | (uint8_t)(p_move_type << 4);
+    }
+
+    if(new_byte != byte)
+    {
+        ObjectMoveType previous_move_type = get_movement(p_cell_idx, p_collision_layer);
+        if(is_recording_changes)
+        {
+            recorded_changes.push_back(LevelChange(LevelChange::Type::MovementChanged, p_cell_idx, p_collision_layer, (uint8_t)previous_move_type));
+        }
+        state_hash ^= get_movement_hash_key(p_cell_idx, p_collision_layer, previous_move_type) ^ get_movement_hash_key(p_cell_idx, p_collision_layer, p_move_type);
+        byte = new_byte;
+        movement_change_stamps[p_collision_layer] = ++change_stamp;
+    }
 }
 
-unordered_set<PSVector2i> PSEngine::ObjectCache::get_object_positions(const shared_ptr<CompiledGame::PrimaryObject> p_object)
+void PSEngine::Level::revert_change(const LevelChange& p_change)
 {
-    return m_content[p_object];
+    bool was_recording_changes = is_recording_changes;
+    is_recording_changes = false;
+
+    switch (p_change.type)
+    {
+    case LevelChange::Type::ObjectAdded:
+        remove_object(p_change.cell_idx, p_change.object_id_or_collision_layer);
+        break;
+    case LevelChange::Type::ObjectRemoved:
+        add_object(p_change.cell_idx, p_change.object_id_or_collision_layer);
+        break;
+    case LevelChange::Type::MovementChanged:
+        set_movement(p_change.cell_idx, p_change.object_id_or_collision_layer, (ObjectMoveType)p_change.previous_movement);
+        break;
+    }
+
+    is_recording_changes = was_recording_changes;
 }
 
-string PSEngine::ObjectCache::to_string()
+void PSEngine::Level::get_cells_containing(const CompiledGame::ObjectMask& p_object_mask, vector<uint64_t>& p_out_cells) const
+{
+    p_out_cells.assign(position_words_per_object, 0);
+    for(int w = 0; w < p_object_mask.words.size(); ++w)
+    {
+        uint64_t mask_bits = p_object_mask.words[w];
+        while(mask_bits != 0)
+        {
+            const uint64_t* obj_positions = get_object_positions(w*64 + pop_lowest_bit_index(mask_bits));
+            for(int i = 0; i < position_words_per_object; ++i)
+            {
+                p_out_cells[i] |= obj_positions[i];
+            }
+        }
+    }
+}
+
+string PSEngine::Level::object_positions_to_string() const
 {
     string res;
-    for(const auto& pair : m_content)
+    int object_count = position_words_per_object == 0 ? 0 : object_positions.size() / position_words_per_object;
+    for(int obj_id = 0; obj_id < object_count; ++obj_id)
     {
-        res += pair.first->to_string() + " : ";
-        for(const auto& elem : pair.second)
+        res += "object " + std::to_string(obj_id) + " : ";
+        const uint64_t* obj_positions = get_object_positions(obj_id);
+        for(int w = 0; w < position_words_per_object; ++w)
         {
-            res += "("+ std::to_string(elem.x) +","+ std::to_string(elem.y)+"), ";
+            uint64_t cells_bits = obj_positions[w];
+            while(cells_bits != 0)
+            {
+                PSVector2i pos = get_cell_position(w*64 + pop_lowest_bit_index(cells_bits));
+                res += "("+ std::to_string(pos.x) +","+ std::to_string(pos.y)+"), ";
+            }
         }
         res += "\n";
     }
@@ -133,25 +335,59 @@ PSEngine::PSEngine(Config p_config, shared_ptr<PSLogger> p_logger /*=nullptr*/)
 
 void PSEngine::load_game(const CompiledGame& p_game_to_load)
 {
-    m_compiled_game = p_game_to_load;
+    load_game(make_shared<const CompiledGame>(p_game_to_load));
+}
+
+void PSEngine::load_game(shared_ptr<const CompiledGame> p_game_to_load)
+{
+    m_compiled_game = std::move(p_game_to_load);
+
+    //objects without collision layer all share an extra layer (see Compiler::reference_collision_layers_in_objects)
+    m_collision_layer_count = (int)m_compiled_game->collision_layers.size() + 1;
+    m_object_collision_layers.clear();
+    m_collision_layer_masks.assign(m_collision_layer_count, CompiledGame::ObjectMask(m_compiled_game->get_object_mask_word_count()));
+    for(const auto& obj : m_compiled_game->primary_objects)
+    {
+        m_object_collision_layers.push_back(obj->collision_layer_id);
+        m_collision_layer_masks[obj->collision_layer_id].set(obj->id);
+    }
+
+    m_player_mask = m_compiled_game->get_object_mask(m_compiled_game->player_object.lock());
+
+    m_win_condition_masks.clear();
+    for(const auto& win_condition : m_compiled_game->win_conditions)
+    {
+        m_win_condition_masks.push_back(make_pair(m_compiled_game->get_object_mask(win_condition.object), m_compiled_game->get_object_mask(win_condition.on_object)));
+    }
+
+    compute_rules_read_infos(m_compiled_game->rules, m_rules_read_infos);
+    compute_rules_read_infos(m_compiled_game->late_rules, m_late_rules_read_infos);
 
     Operation op = Operation(OperationType::LoadGame);
-    op.loaded_game_title = m_compiled_game.prelude_info.title.value_or("TITLE UNKNOWN");
-    m_operation_history.push_back(op);
+    op.loaded_game_title = m_compiled_game->prelude_info.title.value_or("TITLE UNKNOWN");
+    record_operation(op);
+}
+
+void PSEngine::record_operation(const Operation& p_operation)
+{
+    if(m_config.record_operation_history)
+    {
+        m_operation_history.push_back(p_operation);
+    }
 }
 
 void PSEngine::Load_first_level()
 {
     Operation op = Operation(OperationType::LoadLevel);
     op.loaded_level = 0;
-    m_operation_history.push_back(op);
+    record_operation(op);
 
     load_level_internal(0);
 }
 
 optional<PSEngine::TurnHistory> PSEngine::receive_input(InputType p_input)
 {
-    m_operation_history.push_back(Operation(OperationType::Input,p_input));
+    record_operation(Operation(OperationType::Input,p_input));
 
     PS_LOG("Received input : " + enum_to_str(p_input,to_input_type).value_or("ERROR"));
 
@@ -180,14 +416,21 @@ optional<PSEngine::TurnHistory> PSEngine::receive_input(InputType p_input)
         return nullopt;
     }
 
+    //the input movements are part of the turn, so that cancelling or undoing it does not leave them on the players
+    m_current_level.recorded_changes.clear();
+    m_current_level.is_recording_changes = true;
+
     //marking player with input
-    for(Cell& cell : m_current_level.cells)
+    for(int i = 0; i < m_current_level.get_cell_count(); ++i)
     {
-        for(auto& pair :cell.objects)
+        const uint64_t* cell_objects = m_current_level.get_cell_objects(i);
+        for(int w = 0; w < m_current_level.object_words_per_cell; ++w)
         {
-            if(m_compiled_game.player_object.lock()->defines(pair.first))
+            uint64_t player_bits = cell_objects[w] & m_player_mask.words[w];
+            while(player_bits != 0)
             {
-                pair.second = move_type;
+                int obj_id = w*64 + pop_lowest_bit_index(player_bits);
+                m_current_level.set_movement(i, m_object_collision_layers[obj_id], move_type);
             }
         }
     }
@@ -195,9 +438,161 @@ optional<PSEngine::TurnHistory> PSEngine::receive_input(InputType p_input)
     return next_turn();
 }
 
+vector<PSEngine::SimulationResult> PSEngine::simulate_input_sequences(shared_ptr<const CompiledGame> p_game, int p_level_idx, const vector<vector<InputType>>& p_input_sequences, bool p_keep_final_states /*= false*/)
+{
+    vector<SimulationResult> results;
+
+    if(p_game == nullptr || p_level_idx < 0 || p_level_idx >= p_game->levels.size())
+    {
+        return results;
+    }
+
+    shared_ptr<PSLogger> logger = make_shared<PSLogger>();
+    logger->log_verbosity = PSLogger::LogType::Critical;
+
+    Config config;
+    config.log_verbosity = PSLogger::LogType::Critical;
+    config.log_operation_history_after_error = false;
+    config.undo_max_turns = 1;
+    config.record_turn_history = false;
+    config.record_operation_history = false;
+
+    PSEngine engine(config, logger);
+    engine.load_game(std::move(p_game));
+
+    results.reserve(p_input_sequences.size());
+    for(const vector<InputType>& input_sequence : p_input_sequences)
+    {
+        engine.load_level_internal(p_level_idx);
+
+        SimulationResult result;
+        for(InputType input : input_sequence)
+        {
+            engine.receive_input(input);
+            ++result.inputs_played;
+
+            if(engine.m_is_level_won)
+            {
+                break;
+            }
+        }
+
+        result.is_level_won = engine.m_is_level_won;
+        if(p_keep_final_states)
+        {
+            result.final_state = engine.m_current_level;
+        }
+        results.push_back(std::move(result));
+    }
+
+    return results;
+}
+
+void PSEngine::restore_level_content(const uint64_t* p_objects, const uint8_t* p_movements)
+{
+    m_undo_changes.clear();
+    m_undo_turns_change_counts.clear();
+    m_is_level_won = false;
+
+    //the changes go through the level primitives so that the object positions and the change stamps stay valid
+    for(int i = 0; i < m_current_level.get_cell_count(); ++i)
+    {
+        for(int w = 0; w < m_current_level.object_words_per_cell; ++w)
+        {
+            int word_idx = i*m_current_level.object_words_per_cell + w;
+            uint64_t current_bits = m_current_level.objects[word_idx];
+            uint64_t added_bits = p_objects[word_idx] & ~current_bits;
+            uint64_t removed_bits = current_bits & ~p_objects[word_idx];
+            while(removed_bits != 0)
+            {
+                m_current_level.remove_object(i, w*64 + pop_lowest_bit_index(removed_bits));
+            }
+            while(added_bits != 0)
+            {
+                m_current_level.add_object(i, w*64 + pop_lowest_bit_index(added_bits));
+            }
+        }
+    }
+
+    for(int i = 0; i < m_current_level.get_cell_count(); ++i)
+    {
+        for(int b = 0; b < m_current_level.movement_bytes_per_cell; ++b)
+        {
+            int byte_idx = i*m_current_level.movement_bytes_per_cell + b;
+            if(m_current_level.movements[byte_idx] != p_movements[byte_idx])
+            {
+                m_current_level.set_movement(i, b*2, (ObjectMoveType)(p_movements[byte_idx] & 0x0F));
+                m_current_level.set_movement(i, b*2 + 1, (ObjectMoveType)(p_movements[byte_idx] >> 4));
+            }
+        }
+    }
+}
+
+uint64_t PSEngine::compute_rebuilt_level_hash() const
+{
+    Level rebuilt_level;
+    rebuilt_level.init(m_current_level.level_idx, m_current_level.size, (int)m_compiled_game->primary_objects.size(), m_collision_layer_count);
+
+    for(int i = 0; i < m_current_level.get_cell_count(); ++i)
+    {
+        for(int obj_id : m_current_level.get_objects_in_cell(i))
+        {
+            const int col_layer = m_object_collision_layers[obj_id];
+            rebuilt_level.add_object(i, obj_id);
+            rebuilt_level.set_movement(i, col_layer, m_current_level.get_movement(i, col_layer));
+        }
+    }
+
+    return rebuilt_level.state_hash;
+}
+
+int PSEngine::get_win_conditions_distance()
+{
+    int distance = 0;
+    for(int i = 0; i < m_compiled_game->win_conditions.size(); ++i)
+    {
+        const CompiledGame::WinCondition& win_condition = m_compiled_game->win_conditions[i];
+        const CompiledGame::ObjectMask& on_object_mask = m_win_condition_masks[i].second;
+
+        m_current_level.get_cells_containing(m_win_condition_masks[i].first, m_win_condition_cells_scratch);
+
+        int matching_cells = 0;
+        int object_cells = 0;
+        for(int w = 0; w < m_win_condition_cells_scratch.size(); ++w)
+        {
+            uint64_t cells_bits = m_win_condition_cells_scratch[w];
+            while(cells_bits != 0)
+            {
+                const uint64_t* cell_objects = m_current_level.get_cell_objects(w*64 + pop_lowest_bit_index(cells_bits));
+                ++object_cells;
+                if(win_condition.on_object == nullptr || on_object_mask.intersects(cell_objects))
+                {
+                    ++matching_cells;
+                }
+            }
+        }
+
+        switch (win_condition.type)
+        {
+        case CompiledGame::WinConditionType::All:
+            distance += object_cells - matching_cells;
+            break;
+        case CompiledGame::WinConditionType::No:
+            distance += matching_cells;
+            break;
+        case CompiledGame::WinConditionType::Some:
+            distance += matching_cells == 0 ? 1 : 0;
+            break;
+        default:
+            break;
+        }
+    }
+    return distance;
+}
+
 optional<PSEngine::TurnHistory> PSEngine::tick(float p_delta_time)
 {
-    if(!m_compiled_game.prelude_info.realtime_interval.has_value())
+    if(!m_compiled_game->prelude_info.realtime_interval.has_value())
     {
         PS_LOG_ERROR("Trying to tick the engine but the loaded puzzlescript doesn't have realtime setup.");
         return nullopt;
@@ -207,11 +602,11 @@ optional<PSEngine::TurnHistory> PSEngine::tick(float p_delta_time)
     {
         Operation op = Operation(OperationType::Undo);
         op.delta_time = p_delta_time;
-        m_operation_history.push_back(op);
+        record_operation(op);
     }
 
 
-    float realtime_interval = m_compiled_game.prelude_info.realtime_interval.value();
+    float realtime_interval = m_compiled_game->prelude_info.realtime_interval.value();
 
     m_current_tick_time_elapsed += p_delta_time;
 
@@ -228,22 +623,27 @@ optional<PSEngine::TurnHistory> PSEngine::tick(float p_delta_time)
 
 void PSEngine::restart_level()
 {
-    m_operation_history.push_back(Operation(OperationType::Restart));
+    record_operation(Operation(OperationType::Restart));
 
     load_level_internal(m_current_level.level_idx);
 }
 
 bool PSEngine::undo()
 {
-    m_operation_history.push_back(Operation(OperationType::Undo));
+    record_operation(Operation(OperationType::Undo));
 
-    if(m_level_state_stack.size() == 0)
+    if(m_undo_turns_change_counts.size() == 0)
     {
         return false;
     }
 
-    m_current_level = m_level_state_stack.back();
-    m_level_state_stack.pop_back();
+    //the changes are reverted through the level primitives so the change stamps stay valid
+    for(int i = 0; i < m_undo_turns_change_counts.back(); ++i)
+    {
+        m_current_level.revert_change(m_undo_changes.back());
+        m_undo_changes.pop_back();
+    }
+    m_undo_turns_change_counts.pop_back();
 
     return true; //todo ? shouln't we return deltas for undos ?
 }
@@ -251,11 +651,31 @@ bool PSEngine::undo()
 
 optional<PSEngine::TurnHistory> PSEngine::next_turn()
 {
-    Level last_turn_save = m_current_level;
-    TurnHistory last_turn_history_save = m_turn_history;
+    uint64_t turn_start_time = 0;
+    if(m_config.collect_turn_stats)
+    {
+        turn_start_time = get_time_ns();
+        m_turn_stats = TurnStats();
+        m_turn_stats.rules.resize(m_compiled_game->rules.size());
+        m_turn_stats.late_rules.resize(m_compiled_game->late_rules.size());
+    }
+
+    TurnHistory last_turn_history_save = std::move(m_turn_history);
 
     m_turn_history = TurnHistory();
 
+    //every change of the turn is recorded, it is used to cancel the turn and then to undo it
+    //receive_input already started recording to include the input movements
+    if(!m_current_level.is_recording_changes)
+    {
+        m_current_level.recorded_changes.clear();
+        m_current_level.is_recording_changes = true;
+    }
+
+    //the first subturn carries the input movements, so the state before it is only used to know if a subturn changed something
+    uint64_t subturn_start_hash = m_current_level.state_hash;
+    m_subturn_level_hashes.clear();
+
     bool win_requested_by_command = false;
     bool keep_computing_subturn = false;
     do
@@ -264,9 +684,7 @@ optional<PSEngine::TurnHistory> PSEngine::next_turn()
 
         if(next_subturn())
         {
-            vector<CompiledGame::Command> subturn_commands = m_turn_history.subturns.back().gather_all_subturn_commands();
-
-            for(const auto& command : subturn_commands)
+            for(const auto& command : m_subturn_commands)
             {
                 if(command.type == CompiledGame::CommandType::Win)
                 {
@@ -275,11 +693,7 @@ optional<PSEngine::TurnHistory> PSEngine::next_turn()
                 }
                 else if (command.type == CompiledGame::CommandType::Cancel)
                 {
-                    m_current_level = last_turn_save;
-                    TurnHistory cancelled_turn_history = m_turn_history;
-                    cancelled_turn_history.was_turn_cancelled = true;
-                    m_turn_history = last_turn_history_save;
-                    return optional<PSEngine::TurnHistory>(cancelled_turn_history);
+                    return optional<PSEngine::TurnHistory>(cancel_turn(last_turn_history_save, turn_start_time));
                 }
                 else if (command.type == CompiledGame::CommandType::Again)
                 {
@@ -292,46 +706,169 @@ optional<PSEngine::TurnHistory> PSEngine::next_turn()
             }
         }
 
-    } while (keep_computing_subturn); //todo add an infinite loop safety
+        if(keep_computing_subturn)
+        {
+            //the subturns after the first one only depend on the level state, if it comes back to a previous one the again chain will never end
+            uint64_t level_hash = m_current_level.state_hash;
+            int completed_subturn_count = (int)m_subturn_level_hashes.size() + 1;
+            if(level_hash == subturn_start_hash)
+            {
+                //like in puzzlescript, an again after a subturn that changed nothing ends the turn
+                keep_computing_subturn = false;
+            }
+            else if(std::find(m_subturn_level_hashes.begin(), m_subturn_level_hashes.end(), level_hash) != m_subturn_level_hashes.end())
+            {
+                PS_LOG_ERROR("Infinite again loop detected, the level went back to a previous state after " + to_string(completed_subturn_count) + " subturns. Cancelling the turn.");
+                TurnHistory aborted_turn_history = cancel_turn(last_turn_history_save, turn_start_time);
+                aborted_turn_history.was_turn_aborted = true;
+                return optional<PSEngine::TurnHistory>(aborted_turn_history);
+            }
+            else if(m_config.max_subturns_per_turn > 0 && completed_subturn_count >= m_config.max_subturns_per_turn)
+            {
+                PS_LOG_ERROR("The again chain went beyond the limit of " + to_string(m_config.max_subturns_per_turn) + " subturns. Cancelling the turn.");
+                TurnHistory aborted_turn_history = cancel_turn(last_turn_history_save, turn_start_time);
+                aborted_turn_history.was_turn_aborted = true;
+                return optional<PSEngine::TurnHistory>(aborted_turn_history);
+            }
+            else
+            {
+                m_subturn_level_hashes.push_back(level_hash);
+                subturn_start_hash = level_hash;
+            }
+        }
 
-    if( m_turn_history.subturns.size() > 0)
-    {
-        m_level_state_stack.push_back(last_turn_save);
-        print_subturns_history();
-    }
-    //else it means nothing happened
+    } while (keep_computing_subturn);
+
+    m_current_level.is_recording_changes = false;
+
+    //every turn is pushed, even if nothing changed, so that every input can be undone
+    push_undo_turn(m_current_level.recorded_changes);
+    print_subturns_history();
+    m_current_level.recorded_changes.clear();
+
+    uint64_t win_conditions_start_time = m_config.collect_turn_stats ? get_time_ns() : 0;
 
     if(check_win_conditions() || win_requested_by_command)
     {
         m_is_level_won = true;
     }
 
+    if(m_config.collect_turn_stats)
+    {
+        uint64_t turn_end_time = get_time_ns();
+        m_turn_stats.win_conditions_duration_ns = turn_end_time - win_conditions_start_time;
+        m_turn_stats.turn_duration_ns = turn_end_time - turn_start_time;
+    }
+
     return optional<PSEngine::TurnHistory>(m_turn_history);
 }
 
+PSEngine::TurnHistory PSEngine::cancel_turn(TurnHistory& p_last_turn_history_save, uint64_t p_turn_start_time)
+{
+    revert_recorded_changes();
+    TurnHistory cancelled_turn_history = std::move(m_turn_history);
+    cancelled_turn_history.was_turn_cancelled = true;
+    m_turn_history = std::move(p_last_turn_history_save);
+    if(m_config.collect_turn_stats)
+    {
+        m_turn_stats.turn_duration_ns = get_time_ns() - p_turn_start_time;
+    }
+    return cancelled_turn_history;
+}
+
+void PSEngine::revert_recorded_changes()
+{
+    m_current_level.is_recording_changes = false;
+    for(int i = (int)m_current_level.recorded_changes.size() - 1; i >= 0; --i)
+    {
+        m_current_level.revert_change(m_current_level.recorded_changes[i]);
+    }
+    m_current_level.recorded_changes.clear();
+}
+
+void PSEngine::push_undo_turn(const vector<LevelChange>& p_turn_changes)
+{
+    m_undo_changes.insert(m_undo_changes.end(), p_turn_changes.begin(), p_turn_changes.end());
+    m_undo_turns_change_counts.push_back((int)p_turn_changes.size());
+
+    if(m_config.undo_max_turns > 0)
+    {
+        while(m_undo_turns_change_counts.size() > m_config.undo_max_turns)
+        {
+            forget_oldest_undo_turn();
+        }
+    }
+
+    if(m_config.undo_max_memory_bytes > 0)
+    {
+        //the last turn is always kept
+        while(m_undo_turns_change_counts.size() > 1
+        && m_undo_changes.size()*sizeof(LevelChange) + m_undo_turns_change_counts.size()*sizeof(int) > m_config.undo_max_memory_bytes)
+        {
+            forget_oldest_undo_turn();
+        }
+    }
+}
+
+void PSEngine::forget_oldest_undo_turn()
+{
+    m_undo_changes.erase(m_undo_changes.begin(), m_undo_changes.begin() + m_undo_turns_change_counts.front());
+    m_undo_turns_change_counts.pop_front();
+}
+
 bool PSEngine::next_subturn()
 {
     PS_LOG("--- Subturn start ---");
-    Level last_subturn_save = m_current_level;
 
-    m_turn_history.subturns.push_back(SubturnHistory());
+    if(m_config.record_turn_history)
+    {
+        m_turn_history.subturns.push_back(SubturnHistory());
+    }
+    m_subturn_commands.clear();
 
-    m_object_cache.build_cache(m_current_level);
+    if(m_config.collect_turn_stats)
+    {
+        ++m_turn_stats.subturns;
+    }
 
-    for(const auto& rule : m_compiled_game.rules)
+    for(int i = 0; i < m_compiled_game->rules.size(); ++i)
     {
+        const CompiledGame::Rule& rule = m_compiled_game->rules[i];
+        RuleReadInfo& read_info = m_rules_read_infos[i];
+        RuleStats* rule_stats = m_config.collect_turn_stats ? &m_turn_stats.rules[i] : nullptr;
+
+        if(!is_rule_dirty(read_info))
+        {
+            PS_LOG_VERBOSE("Skipping rule since nothing it reads changed : " + rule.to_string());
+            if(rule_stats != nullptr)
+            {
+                ++rule_stats->skips;
+            }
+            continue;
+        }
+
         PS_LOG("Processing rule : " + rule.to_string());
-        apply_rule(rule);
+        read_info.no_match_stamp = process_rule(i, false, rule_stats) ? 0 : m_current_level.change_stamp;
     }
 
-    if( !resolve_movements() )
+    uint64_t movement_start_time = m_config.collect_turn_stats ? get_time_ns() : 0;
+
+    bool movements_resolved = resolve_movements();
+
+    if(m_config.collect_turn_stats)
+    {
+        ++m_turn_stats.movement_resolutions;
+        m_turn_stats.movement_duration_ns += get_time_ns() - movement_start_time;
+    }
+
+    if( !movements_resolved )
     {
         //todo : for now, movement should always successfully resolve
         //need to decide what to do and add in the history if a movement phase can be considered as unresolved
         //(ie: in puzzlescript there's an option to cancel the whole turn if the player cannot move for example)
         assert(false);
         /*PS_LOG("could not resolve movement, cancelling the turn.");
-        m_current_level = last_subturn_save;
+        revert_recorded_changes();
         m_turn_history.pop_back();*/
         return false;
     }
@@ -339,201 +876,107 @@ bool PSEngine::next_subturn()
     {
         PS_LOG("movement resolved");
 
-        for(const auto& rule : m_compiled_game.late_rules)
+        for(int i = 0; i < m_compiled_game->late_rules.size(); ++i)
         {
+            const CompiledGame::Rule& rule = m_compiled_game->late_rules[i];
+            RuleReadInfo& read_info = m_late_rules_read_infos[i];
+            RuleStats* rule_stats = m_config.collect_turn_stats ? &m_turn_stats.late_rules[i] : nullptr;
+
+            if(!is_rule_dirty(read_info))
+            {
+                PS_LOG_VERBOSE("Skipping late rule since nothing it reads changed : " + rule.to_string());
+                if(rule_stats != nullptr)
+                {
+                    ++rule_stats->skips;
+                }
+                continue;
+            }
+
             PS_LOG("Processing late rule : " + rule.to_string());
-            apply_rule(rule);
+            read_info.no_match_stamp = process_rule(i, true, rule_stats) ? 0 : m_current_level.change_stamp;
         }
 
-        PS_LOG(m_object_cache.to_string());
+        PS_LOG(m_current_level.object_positions_to_string());
 
         return true;
     }
 }
 
 
-optional<set<PSEngine::ObjectMoveType>> PSEngine::convert_entity_rule_info_to_allowed_move_types(CompiledGame::EntityRuleInfo p_entity_rule_info, AbsoluteDirection p_rule_app_dir)
+bool PSEngine::process_rule(int p_rule_idx, bool p_is_late_rule, RuleStats* p_rule_stats)
 {
-    if(p_entity_rule_info == CompiledGame::EntityRuleInfo::No
-    || p_entity_rule_info == CompiledGame::EntityRuleInfo::None)
+    if(p_rule_stats == nullptr)
     {
-        return nullopt;
+        return apply_rule(p_rule_idx, p_is_late_rule);
     }
 
-    map<AbsoluteDirection,map<CompiledGame::EntityRuleInfo,ObjectMoveType>> relative_dirs_lookup_table =
-    {
-        {AbsoluteDirection::Up,
-            {{CompiledGame::EntityRuleInfo::RelativeUp,ObjectMoveType::Left},
-            {CompiledGame::EntityRuleInfo::RelativeDown,ObjectMoveType::Right},
-            {CompiledGame::EntityRuleInfo::RelativeLeft,ObjectMoveType::Down},
-            {CompiledGame::EntityRuleInfo::RelativeRight,ObjectMoveType::Up},}},
-        {AbsoluteDirection::Down,
-            {{CompiledGame::EntityRuleInfo::RelativeUp,ObjectMoveType::Right},
-            {CompiledGame::EntityRuleInfo::RelativeDown,ObjectMoveType::Left},
-            {CompiledGame::EntityRuleInfo::RelativeLeft,ObjectMoveType::Up},
-            {CompiledGame::EntityRuleInfo::RelativeRight,ObjectMoveType::Down},}},
-        {AbsoluteDirection::Left,
-            {{CompiledGame::EntityRuleInfo::RelativeUp,ObjectMoveType::Down},
-            {CompiledGame::EntityRuleInfo::RelativeDown,ObjectMoveType::Up},
-            {CompiledGame::EntityRuleInfo::RelativeLeft,ObjectMoveType::Right},
-            {CompiledGame::EntityRuleInfo::RelativeRight,ObjectMoveType::Left},}},
-        {AbsoluteDirection::Right,
-            {{CompiledGame::EntityRuleInfo::RelativeUp,ObjectMoveType::Up},
-            {CompiledGame::EntityRuleInfo::RelativeDown,ObjectMoveType::Down},
-            {CompiledGame::EntityRuleInfo::RelativeLeft,ObjectMoveType::Left},
-            {CompiledGame::EntityRuleInfo::RelativeRight,ObjectMoveType::Right},}},
-    };
-    set<ObjectMoveType> results;
+    uint64_t start_time = get_time_ns();
+    m_current_rule_stats = p_rule_stats;
 
-    switch (p_entity_rule_info )
-    {
-    case CompiledGame::EntityRuleInfo::Stationary:
-        break;
-    case CompiledGame::EntityRuleInfo::Up:
-        results.insert(ObjectMoveType::Up);
-        break;
-    case CompiledGame::EntityRuleInfo::Down:
-        results.insert(ObjectMoveType::Down);
-        break;
-    case CompiledGame::EntityRuleInfo::Left:
-        results.insert(ObjectMoveType::Left);
-        break;
-    case CompiledGame::EntityRuleInfo::Right:
-        results.insert(ObjectMoveType::Right);
-        break;
-    case CompiledGame::EntityRuleInfo::Horizontal:
-        results.insert(ObjectMoveType::Left);
-        results.insert(ObjectMoveType::Right);
-        break;
-    case CompiledGame::EntityRuleInfo::Vertical:
-        results.insert(ObjectMoveType::Up);
-        results.insert(ObjectMoveType::Down);
-        break;
-    case CompiledGame::EntityRuleInfo::Orthogonal:
-        results.insert(ObjectMoveType::Up);
-        results.insert(ObjectMoveType::Down);
-        results.insert(ObjectMoveType::Left);
-        results.insert(ObjectMoveType::Right);
-        break;
-    case CompiledGame::EntityRuleInfo::Action:
-        results.insert(ObjectMoveType::Action);
-        break;
-    case CompiledGame::EntityRuleInfo::Moving:
-        results.insert(ObjectMoveType::Action);
-        results.insert(ObjectMoveType::Up);
-        results.insert(ObjectMoveType::Down);
-        results.insert(ObjectMoveType::Left);
-        results.insert(ObjectMoveType::Right);
-        break;
-    case CompiledGame::EntityRuleInfo::RelativeUp:
-        results.insert(relative_dirs_lookup_table[p_rule_app_dir][CompiledGame::EntityRuleInfo::RelativeUp]);
-        break;
-    case CompiledGame::EntityRuleInfo::RelativeDown:
-        results.insert(relative_dirs_lookup_table[p_rule_app_dir][CompiledGame::EntityRuleInfo::RelativeDown]);
-        break;
-    case CompiledGame::EntityRuleInfo::RelativeLeft:
-        results.insert(relative_dirs_lookup_table[p_rule_app_dir][CompiledGame::EntityRuleInfo::RelativeLeft]);
-        break;
-    case CompiledGame::EntityRuleInfo::RelativeRight:
-        results.insert(relative_dirs_lookup_table[p_rule_app_dir][CompiledGame::EntityRuleInfo::RelativeRight]);
-        break;
-    case CompiledGame::EntityRuleInfo::Perpendicular:
-        results.insert(relative_dirs_lookup_table[p_rule_app_dir][CompiledGame::EntityRuleInfo::RelativeUp]);
-        results.insert(relative_dirs_lookup_table[p_rule_app_dir][CompiledGame::EntityRuleInfo::RelativeDown]);
-        break;
-    case CompiledGame::EntityRuleInfo::Parallel:
-        results.insert(relative_dirs_lookup_table[p_rule_app_dir][CompiledGame::EntityRuleInfo::RelativeRight]);
-        results.insert(relative_dirs_lookup_table[p_rule_app_dir][CompiledGame::EntityRuleInfo::RelativeLeft]);
-        break;
+    bool rule_applied = apply_rule(p_rule_idx, p_is_late_rule);
 
-    default:
-        break;
-    }
+    m_current_rule_stats = nullptr;
+    ++p_rule_stats->evaluations;
+    p_rule_stats->duration_ns += get_time_ns() - start_time;
 
-    return optional<set<ObjectMoveType>> (results);
+    return rule_applied;
 }
 
 bool PSEngine::does_move_info_matches_rule(ObjectMoveType p_move_type, CompiledGame::EntityRuleInfo p_rule_info, AbsoluteDirection p_rule_dir)
 {
-    if(p_rule_info == CompiledGame::EntityRuleInfo::None)
-    {
-        return true;
-    }
-    else if( p_rule_info == CompiledGame::EntityRuleInfo::No)
+    assert(p_rule_info != CompiledGame::EntityRuleInfo::No);
+    return (allowed_move_types_table[(int)p_rule_info][(int)p_rule_dir] & move_type_bit(p_move_type)) != 0;
+}
+
+bool PSEngine::does_rule_cell_matches_cell(const CompiledGame::CellRule& p_rule_cell, int p_cell_idx, AbsoluteDirection p_rule_application_direction)
+{
+    if(p_cell_idx < 0 || p_rule_cell.can_never_match)
     {
-        assert(false);
-        PS_LOG_ERROR("should not happen");
         return false;
     }
-    else
-    {
-        optional<set<ObjectMoveType>> move_types_opt = convert_entity_rule_info_to_allowed_move_types(p_rule_info,p_rule_dir);
 
-        if(move_types_opt.has_value())
-        {
-            set<PSEngine::ObjectMoveType>allowed_move_types = move_types_opt.value();
+    const uint64_t* cell_objects = m_current_level.get_cell_objects(p_cell_idx);
+    const int word_count = m_current_level.object_words_per_cell;
 
-            if(allowed_move_types.size() == 0)
-            {
-                return p_move_type == PSEngine::ObjectMoveType::Stationary;
-            }
-            else
-            {
-                return allowed_move_types.find(p_move_type) != allowed_move_types.end();
-            }
-        }
-        else
+    for(int w = 0; w < word_count; ++w)
+    {
+        if((cell_objects[w] & p_rule_cell.required_objects.words[w]) != p_rule_cell.required_objects.words[w]
+        || (cell_objects[w] & p_rule_cell.forbidden_objects.words[w]) != 0)
         {
-            assert(false);
-            PS_LOG_ERROR("should not happen");
             return false;
         }
     }
-}
-
-bool PSEngine::does_rule_cell_matches_cell(const CompiledGame::CellRule& p_rule_cell, const PSEngine::Cell* p_cell, AbsoluteDirection p_rule_application_direction)
-{
-    if(!p_cell)
-    {
-        return false;
-    }
 
-    for(pair<shared_ptr<CompiledGame::Object>,CompiledGame::EntityRuleInfo> rule_pair : p_rule_cell.content)
+    for(const CompiledGame::ObjectMask& any_of_mask : p_rule_cell.any_of_objects)
     {
-        bool found_object = false;
-
-        ObjectMoveType first_found_object_move_type = ObjectMoveType::None;
-
-        for(const auto& cell_pair : p_cell->objects)
+        int found_count = 0;
+        for(int w = 0; w < word_count; ++w)
         {
-            if(rule_pair.first->defines( cell_pair.first))
-            {
-                if(!found_object)
-                {
-                    first_found_object_move_type = cell_pair.second;
-                    found_object = true;
-                }
-                else
-                {
-                    //todo in some cases, such as when no delta apply to ambiguous object, it should not be an error
-                    PS_LOG_ERROR("detected multiple object that match the definition. this is ambiguous");
-                    return false;
-                }
-            }
+            found_count += bit_count(cell_objects[w] & any_of_mask.words[w]);
         }
 
-        if(rule_pair.second == CompiledGame::EntityRuleInfo::No)
+        if(found_count == 0)
         {
-            if(found_object)
-            {
-                return false;
-            }
+            return false;
         }
-        else if(!found_object)
+        else if(found_count > 1)
         {
+            //todo in some cases, such as when no delta apply to ambiguous object, it should not be an error
+            PS_LOG_ERROR("detected multiple object that match the definition. this is ambiguous");
             return false;
         }
-        else if(!does_move_info_matches_rule(first_found_object_move_type, rule_pair.second, p_rule_application_direction))
+    }
+
+    for(const CompiledGame::CellRule::MovementRequirement& movement_requirement : p_rule_cell.movement_requirements)
+    {
+        int obj_id = movement_requirement.object_id;
+        if(obj_id == -1)
+        {
+            obj_id = find_object_in_cell(p_cell_idx, p_rule_cell.any_of_objects[movement_requirement.any_of_index]);
+        }
+
+        ObjectMoveType move_type = m_current_level.get_movement(p_cell_idx, m_object_collision_layers[obj_id]);
+        if(!does_move_info_matches_rule(move_type, movement_requirement.rule_info, p_rule_application_direction))
         {
             return false;
         }
@@ -542,14 +985,39 @@ bool PSEngine::does_rule_cell_matches_cell(const CompiledGame::CellRule& p_rule_
     return true;
 }
 
+int PSEngine::find_object_in_cell(int p_cell_idx, const CompiledGame::ObjectMask& p_mask) const
+{
+    const uint64_t* cell_objects = m_current_level.get_cell_objects(p_cell_idx);
+
+    //when several objects match, the one with the highest id is returned
+    for(int w = m_current_level.object_words_per_cell - 1; w >= 0; --w)
+    {
+        uint64_t bits = cell_objects[w] & p_mask.words[w];
+        if(bits != 0)
+        {
+            int highest_bit = -1;
+            while(bits != 0)
+            {
+                highest_bit = pop_lowest_bit_index(bits);
+            }
+            return w*64 + highest_bit;
+        }
+    }
+
+    return -1;
+}
+
 PSEngine::RuleApplicationDelta PSEngine::translate_rule_delta(const CompiledGame::Rule& p_rule, AbsoluteDirection p_rule_app_dir,const vector<PatternMatchInformation>& p_pattern_match_infos)
 {
     RuleApplicationDelta delta;
 
-    delta.match_infos = p_pattern_match_infos;
     delta.rule_direction = p_rule_app_dir;
+    for(const PatternMatchInformation& match_infos : p_pattern_match_infos)
+    {
+        delta.match_origins.push_back(get_cell_at(match_infos.origin));
+    }
 
-    auto get_cell = [this](int cell_index, PatternMatchInformation infos, AbsoluteDirection apply_dir)
+    auto get_cell = [this](int cell_index, const PatternMatchInformation& infos, AbsoluteDirection apply_dir)
     {
         int offset = 0;
         assert(infos.wildcard_match_distances.size() == infos.wildcard_pattern_cell_indexes.size());
@@ -560,35 +1028,24 @@ PSEngine::RuleApplicationDelta PSEngine::translate_rule_delta(const CompiledGame
                 offset += infos.wildcard_match_distances[i];
             }
         }
-        return get_cell_from(infos.origin,offset+cell_index,apply_dir);
+        return get_cell_from(get_cell_at(infos.origin),offset+cell_index,apply_dir);
     };
 
-    for(auto rule_delta : p_rule.deltas)
+    for(const auto& rule_delta : p_rule.deltas)
     {
-        PatternMatchInformation current_pattern_match_infos = p_pattern_match_infos[rule_delta.pattern_index];
-        Cell* match_cell = get_cell(rule_delta.delta_match_index, current_pattern_match_infos, p_rule_app_dir);
-        Cell* apply_cell = get_cell(rule_delta.delta_application_index, current_pattern_match_infos, p_rule_app_dir);
-        assert(match_cell != nullptr && apply_cell != nullptr);
-
-        shared_ptr<CompiledGame::PrimaryObject> matched_primary_obj;
+        const PatternMatchInformation& current_pattern_match_infos = p_pattern_match_infos[rule_delta.pattern_index];
+        int match_cell = get_cell(rule_delta.delta_match_index, current_pattern_match_infos, p_rule_app_dir);
+        int apply_cell = get_cell(rule_delta.delta_application_index, current_pattern_match_infos, p_rule_app_dir);
+        assert(match_cell != -1 && apply_cell != -1);
 
         //todo could not always checking if the object matches cause some problems ? probably too late to find out tonight
-        if(rule_delta.object->as_primary_object() != nullptr)
+        int matched_obj_id = rule_delta.primary_object_id;
+        if(matched_obj_id == -1)
         {
-            matched_primary_obj = rule_delta.object->as_primary_object();
-        }
-        else
-        {
-            for(const auto& level_cell_pair : match_cell->objects)
-            {
-                if(rule_delta.object->defines( level_cell_pair.first))
-                {
-                    matched_primary_obj = level_cell_pair.first;
-                }
-            }
+            matched_obj_id = find_object_in_cell(match_cell, rule_delta.object_mask);
         }
 
-        if(matched_primary_obj)
+        if(matched_obj_id != -1)
         {
             CompiledGame::ObjectDeltaType delta_type = rule_delta.delta_type;
 
@@ -598,16 +1055,12 @@ PSEngine::RuleApplicationDelta PSEngine::translate_rule_delta(const CompiledGame
             || delta_type == CompiledGame::ObjectDeltaType::RelativeLeft
             || delta_type == CompiledGame::ObjectDeltaType::RelativeRight)
             {
-                //todo this is some really ugly conversion code
-                CompiledGame::EntityRuleInfo rule_info = str_to_enum(enum_to_str(delta_type,CompiledGame::to_object_delta_type).value_or("error"),CompiledGame::to_entity_rule_info).value_or(CompiledGame::EntityRuleInfo::None);
-                set<ObjectMoveType> move_types = convert_entity_rule_info_to_allowed_move_types(rule_info,p_rule_app_dir).value();
-                assert(move_types.size() == 1);
-                delta_type = str_to_enum(enum_to_str(*move_types.begin(),to_object_move_type).value_or("error"),CompiledGame::to_object_delta_type).value_or(CompiledGame::ObjectDeltaType::None);
+                int relative_idx = (int)delta_type - (int)CompiledGame::ObjectDeltaType::RelativeUp;
+                delta_type = move_type_to_delta_type_table[relative_move_types_table[(int)p_rule_app_dir][relative_idx]];
                 assert(delta_type != CompiledGame::ObjectDeltaType::None);
             }
 
-            ObjectDelta obj_delta(apply_cell->position,matched_primary_obj,delta_type);
-            delta.object_deltas.push_back(obj_delta);
+            delta.object_deltas.push_back(ObjectDelta(apply_cell, matched_obj_id, delta_type));
         }
         else if( !rule_delta.is_optional)
         {
@@ -617,34 +1070,43 @@ PSEngine::RuleApplicationDelta PSEngine::translate_rule_delta(const CompiledGame
 
     return delta;
 }
-vector<PSEngine::PatternMatchInformation> PSEngine::match_pattern(const CompiledGame::Pattern& p_pattern, AbsoluteDirection p_rule_application_direction, optional<unordered_set<PSVector2i>> p_application_positions)
+void PSEngine::match_pattern(const CompiledGame::Pattern& p_pattern, AbsoluteDirection p_rule_application_direction, const PatternCandidates& p_candidates, vector<PatternMatchInformation>& p_out_matches)
 {
-    vector<PatternMatchInformation> match_results;
+    p_out_matches.clear();
 
-    vector<Cell*> cells_subset;
-    if(p_application_positions.has_value())
-    {
-        for(const auto& position : p_application_positions.value())
-        {
-            cells_subset.push_back(get_cell_at(position));
-        }
-    }
+    const AbsoluteDirection anchor_to_origin_direction = opposite_direction_table[(int)p_rule_application_direction];
 
-    //todo : this is quite ugly but it's late and i juste want to finish this
-    int i_max = p_application_positions.has_value() ? p_application_positions.value().size() : m_current_level.cells.size();
-    for(int i = 0; i < i_max; ++i)
+    const int cell_count = m_current_level.get_cell_count();
+    for(int cell_idx = 0; cell_idx < cell_count; ++cell_idx)
     {
-        //todo: why bother at all retrieving the cell ? we seem to only care about the position
-        Cell* cell = nullptr;
-        if(p_application_positions.has_value())
+        int origin_cell_idx = cell_idx;
+
+        if(p_candidates.is_restricted)
         {
-            cell = cells_subset[i];
+            //jump directly to the next anchor cell of the bitset
+            uint64_t remaining_cells = p_candidates.anchor_cells[cell_idx/64] >> (cell_idx%64);
+            if(remaining_cells == 0)
+            {
+                cell_idx += 63 - (cell_idx%64);
+                continue;
+            }
+            cell_idx += pop_lowest_bit_index(remaining_cells);
+
+            //since the anchor is always at the same distance from the origin, the origins are visited in the same order as the anchors
+            origin_cell_idx = get_cell_from(cell_idx, p_candidates.anchor_distance, anchor_to_origin_direction);
+            if(origin_cell_idx == -1)
+            {
+                continue;
+            }
         }
-        else
+
+        if(m_current_rule_stats != nullptr)
         {
-            cell = get_cell_at(i);
+            ++m_current_rule_stats->candidate_cells;
         }
 
+        PSVector2i cell_position = m_current_level.get_cell_position(origin_cell_idx);
+
         bool match_success = true;
         PatternMatchInformation current_match;
         int board_distance = 0; //cannot use i to navigate the board since it does not take into account potentials "..." offsets
@@ -659,7 +1121,10 @@ vector<PSEngine::PatternMatchInformation> PSEngine::match_pattern(const Compiled
                 int wildcard_match_distance = 0;
                 bool matched_wildcard = false;
 
-                while( Cell* board_cell =  get_cell_from(cell->position, board_distance + wildcard_match_distance, p_rule_application_direction) )
+                const int stride = m_current_level.direction_strides[(int)p_rule_application_direction];
+                const int max_wildcard_match_distance = m_current_level.get_distance_to_edge(origin_cell_idx, p_rule_application_direction) - board_distance;
+                int board_cell = origin_cell_idx + board_distance*stride;
+                for(; wildcard_match_distance <= max_wildcard_match_distance; ++wildcard_match_distance, board_cell += stride)
                 {
                     if(does_rule_cell_matches_cell(
                         next_match_cell,
@@ -669,8 +1134,6 @@ vector<PSEngine::PatternMatchInformation> PSEngine::match_pattern(const Compiled
                         matched_wildcard = true;
                         break;
                     }
-
-                    ++wildcard_match_distance;
                 }
 
                 if(matched_wildcard)
@@ -695,179 +1158,389 @@ vector<PSEngine::PatternMatchInformation> PSEngine::match_pattern(const Compiled
             }
             else if(!does_rule_cell_matches_cell(
                 match_cell,
-                get_cell_from(cell->position, board_distance, p_rule_application_direction),
+                get_cell_from(origin_cell_idx, board_distance, p_rule_application_direction),
                 p_rule_application_direction))
             {
-                match_success = false;
-                break;
+                match_success = false;
+                break;
+            }
+
+            ++board_distance;
+        }
+
+        if(match_success)
+        {
+            current_match.origin = cell_position;
+            p_out_matches.push_back(current_match);
+        }
+    }
+}
+
+string PSEngine::match_origins_to_string(AbsoluteDirection p_rule_app_dir, const vector<int>& p_match_origins) const
+{
+    string result = enum_to_str(p_rule_app_dir, to_absolute_direction).value_or("error");
+    for(int origin_cell_idx : p_match_origins)
+    {
+        PSVector2i origin = m_current_level.get_cell_position(origin_cell_idx);
+        result += " ("+to_string(origin.x)+","+to_string(origin.y)+") ";
+    }
+    return result;
+}
+
+bool PSEngine::find_cells_for_cell_rule(const CompiledGame::CellRule& p_cell_rule, vector<uint64_t>& p_out_cells)
+{
+    const int position_words = m_current_level.position_words_per_object;
+
+    if(p_cell_rule.can_never_match)
+    {
+        p_out_cells.assign(position_words, 0);
+        return true;
+    }
+
+    bool is_restricted = false;
+    auto intersect_with = [&](const uint64_t* p_cells)
+    {
+        if(!is_restricted)
+        {
+            p_out_cells.assign(p_cells, p_cells + position_words);
+            is_restricted = true;
+        }
+        else
+        {
+            for(int i = 0; i < position_words; ++i)
+            {
+                p_out_cells[i] &= p_cells[i];
+            }
+        }
+    };
+
+    for(int w = 0; w < p_cell_rule.required_objects.words.size(); ++w)
+    {
+        uint64_t required_bits = p_cell_rule.required_objects.words[w];
+        while(required_bits != 0)
+        {
+            intersect_with(m_current_level.get_object_positions(w*64 + pop_lowest_bit_index(required_bits)));
+        }
+    }
+
+    for(const CompiledGame::ObjectMask& any_of_mask : p_cell_rule.any_of_objects)
+    {
+        m_current_level.get_cells_containing(any_of_mask, m_entity_cells_scratch);
+        intersect_with(m_entity_cells_scratch.data());
+    }
+
+    if(!p_cell_rule.forbidden_objects.is_empty())
+    {
+        if(!is_restricted)
+        {
+            //start from every cell of the level
+            const int cell_count = m_current_level.get_cell_count();
+            p_out_cells.assign(position_words, ~(uint64_t)0);
+            if(cell_count % 64 != 0)
+            {
+                p_out_cells.back() = ((uint64_t)1 << (cell_count % 64)) - 1;
+            }
+            is_restricted = true;
+        }
+
+        m_current_level.get_cells_containing(p_cell_rule.forbidden_objects, m_entity_cells_scratch);
+        for(int i = 0; i < position_words; ++i)
+        {
+            p_out_cells[i] &= ~m_entity_cells_scratch[i];
+        }
+    }
+
+    return is_restricted;
+}
+
+bool PSEngine::find_cells_for_rule_application(const CompiledGame::Rule& p_rule)
+{
+    assert(p_rule.match_patterns.size() > 0);
+
+    if(m_pattern_candidates_scratch.size() < p_rule.match_patterns.size())
+    {
+        m_pattern_candidates_scratch.resize(p_rule.match_patterns.size());
+    }
+
+    for(int pattern_idx = 0; pattern_idx < p_rule.match_patterns.size(); ++pattern_idx)
+    {
+        const CompiledGame::Pattern& pattern = p_rule.match_patterns[pattern_idx];
+        assert(pattern.cells.size() > 0);
+
+        PatternCandidates& candidates = m_pattern_candidates_scratch[pattern_idx];
+        candidates.is_restricted = false;
+        int min = -1;
+
+        //every rule cell before the first "..." is at a fixed distance from the pattern origin, the one with the fewest candidates is used as the anchor
+        for(int distance = 0; distance < pattern.cells.size() && !pattern.cells[distance].is_wildcard_cell; ++distance)
+        {
+            if(!find_cells_for_cell_rule(pattern.cells[distance], m_cell_rule_cells_scratch))
+            {
+                continue;
+            }
+
+            int count = 0;
+            for(uint64_t cells_word : m_cell_rule_cells_scratch)
+            {
+                count += bit_count(cells_word);
             }
 
-            ++board_distance;
-        }
+            if(min == -1 || count < min)
+            {
+                min = count;
+                candidates.is_restricted = true;
+                candidates.anchor_distance = distance;
+                candidates.anchor_cells.swap(m_cell_rule_cells_scratch);
+            }
 
-        if(match_success)
-        {
-            current_match.origin = cell->position;
-            match_results.push_back(current_match);
+            if(min == 0)
+            {
+                return false;
+            }
         }
     }
 
-    return match_results;
+    return true;
 }
 
-optional<unordered_set<PSVector2i>> PSEngine::find_cells_for_rule_application(const CompiledGame::Rule& p_rule)
+void PSEngine::compute_rules_read_infos(const vector<CompiledGame::Rule>& p_rules, vector<RuleReadInfo>& p_out_read_infos)
 {
-    assert(p_rule.match_patterns.size() > 0);
-    assert(p_rule.match_patterns[0].cells.size() > 0);
-
-    int min = -1;
-    unordered_set<PSVector2i> min_set;
+    const int mask_word_count = m_compiled_game->get_object_mask_word_count();
 
-    //for now only look for the element in the first cell of the first pattern that is the rarest in the level
-    for(const auto& obj_pair :  p_rule.match_patterns[0].cells[0].content)
+    p_out_read_infos.clear();
+    for(const CompiledGame::Rule& rule : p_rules)
     {
-        if(obj_pair.first->is_aggregate() || obj_pair.second == CompiledGame::EntityRuleInfo::No)
+        RuleReadInfo read_info;
+        read_info.objects = CompiledGame::ObjectMask(mask_word_count);
+        vector<bool> reads_layer_movement(m_collision_layer_count, false);
+
+        for(const CompiledGame::Pattern& pattern : rule.match_patterns)
         {
-            //todo :
-            //aggregates and the no keyword is not supported here for now
-            //probably have to find a way to efficiently intersect two sets to make it possible??
-            continue;
-        }
+            for(const CompiledGame::CellRule& cell_rule : pattern.cells)
+            {
+                for(int w = 0; w < mask_word_count; ++w)
+                {
+                    read_info.objects.words[w] |= cell_rule.required_objects.words[w] | cell_rule.forbidden_objects.words[w];
+                    for(const CompiledGame::ObjectMask& any_of_mask : cell_rule.any_of_objects)
+                    {
+                        read_info.objects.words[w] |= any_of_mask.words[w];
+                    }
+                }
 
-        vector<weak_ptr<CompiledGame::PrimaryObject>> primary_objects;
-        obj_pair.first->GetAllPrimaryObjects(primary_objects, true);
-        unordered_set<PSVector2i> current_set;
+                for(const CompiledGame::CellRule::MovementRequirement& movement_requirement : cell_rule.movement_requirements)
+                {
+                    if(movement_requirement.object_id != -1)
+                    {
+                        reads_layer_movement[m_object_collision_layers[movement_requirement.object_id]] = true;
+                    }
+                    else
+                    {
+                        for(int obj_id = 0; obj_id < m_compiled_game->primary_objects.size(); ++obj_id)
+                        {
+                            if(cell_rule.any_of_objects[movement_requirement.any_of_index].test(obj_id))
+                            {
+                                reads_layer_movement[m_object_collision_layers[obj_id]] = true;
+                            }
+                        }
+                    }
+                }
+            }
+        }
 
-        for(const auto& prim_obj : primary_objects)
+        for(int layer = 0; layer < m_collision_layer_count; ++layer)
         {
-            unordered_set<PSVector2i> obj_set = m_object_cache.get_object_positions(prim_obj.lock());
-            //todo : write my own unordered_set union since i couldn't find one in the std :/
-            for( const auto& pos : obj_set)
+            if(reads_layer_movement[layer])
             {
-                current_set.insert(pos);
+                read_info.movement_collision_layers.push_back(layer);
             }
         }
 
+        p_out_read_infos.push_back(read_info);
+    }
+}
+
+bool PSEngine::is_rule_dirty(const RuleReadInfo& p_read_info) const
+{
+    if(p_read_info.no_match_stamp == 0)
+    {
+        return true;
+    }
 
-        if (min == -1 || current_set.size() < min)
+    for(int w = 0; w < p_read_info.objects.words.size(); ++w)
+    {
+        uint64_t object_bits = p_read_info.objects.words[w];
+        while(object_bits != 0)
         {
-            min = current_set.size();
-            min_set = current_set;
+            if(m_current_level.object_change_stamps[w*64 + pop_lowest_bit_index(object_bits)] > p_read_info.no_match_stamp)
+            {
+                return true;
+            }
         }
     }
 
-    if(min == -1)
+    for(int layer : p_read_info.movement_collision_layers)
     {
-        return nullopt;
+        if(m_current_level.movement_change_stamps[layer] > p_read_info.no_match_stamp)
+        {
+            return true;
+        }
     }
-    else
+
+    return false;
+}
+
+void PSEngine::invalidate_rules_read_infos()
+{
+    for(RuleReadInfo& read_info : m_rules_read_infos)
     {
-        return optional<unordered_set<PSVector2i>>(min_set);
+        read_info.no_match_stamp = 0;
+    }
+    for(RuleReadInfo& read_info : m_late_rules_read_infos)
+    {
+        read_info.no_match_stamp = 0;
     }
 }
 
-void PSEngine::apply_rule(const CompiledGame::Rule& p_rule)
+bool PSEngine::apply_rule(int p_rule_idx, bool p_is_late_rule)
 {
-    optional<unordered_set<PSVector2i>> application_positions = find_cells_for_rule_application(p_rule);
+    const CompiledGame::Rule& rule = get_rule(p_rule_idx, p_is_late_rule);
 
-    if(application_positions.has_value() && application_positions.value().size() == 0)
+    if(!find_cells_for_rule_application(rule))
     {
         //there is currently no cell where this rule could be applied in the level
-        return;
+        return false;
     }
 
     RuleDelta rule_delta;
 
-    set<AbsoluteDirection> application_directions = get_absolute_directions_from_rule_direction(p_rule.direction);
+    const int pattern_count = rule.match_patterns.size();
+    if(m_pattern_matches_scratch.size() < pattern_count)
+    {
+        m_pattern_matches_scratch.resize(pattern_count);
+    }
+    m_match_combination_scratch.resize(pattern_count);
+    m_match_combination_indexes_scratch.resize(pattern_count);
+    m_rule_application_delta_hashes.clear();
+
+    const vector<AbsoluteDirection>& application_directions = get_absolute_directions_from_rule_direction(rule.direction);
 
     for(auto rule_app_dir : application_directions)
     {
-        std::function<void(int,vector<PatternMatchInformation>)> compute_pattern_match_combinations = [&](int rule_pattern_index, vector<PatternMatchInformation> current_match_combination){
-            if(rule_pattern_index >= p_rule.match_patterns.size())
+        //the matches of a pattern do not depend on the other patterns so they are computed once and then combined
+        bool all_patterns_matched = true;
+        for(int pattern_idx = 0; pattern_idx < pattern_count; ++pattern_idx)
+        {
+            match_pattern(rule.match_patterns[pattern_idx], rule_app_dir, m_pattern_candidates_scratch[pattern_idx], m_pattern_matches_scratch[pattern_idx]);
+
+            if(m_current_rule_stats != nullptr)
             {
-                RuleApplicationDelta application_delta = translate_rule_delta(p_rule, rule_app_dir, current_match_combination);
+                m_current_rule_stats->matches += (int)m_pattern_matches_scratch[pattern_idx].size();
+            }
 
-                //do not add exactly identical deltas
-                //todo this could and should probably done by the compiler (altough maybe not all equalities could be caught by the compiler)
-                bool add_delta = true;
-                string matched_delta_app_str = "";
-                for(const auto& app_delta : rule_delta.rule_application_deltas)
-                {
-                    if(app_delta == application_delta)
-                    {
-                        add_delta = false;
-                        matched_delta_app_str = enum_to_str(rule_app_dir, to_absolute_direction).value_or("error");
-                        for(const auto& m : current_match_combination)
-                        {
-                            matched_delta_app_str += " ("+to_string(m.origin.x)+","+to_string(m.origin.y)+") ";
-                        }
+            if(m_pattern_matches_scratch[pattern_idx].empty())
+            {
+                all_patterns_matched = false;
+                break;
+            }
+        }
 
-                        break;
-                    }
-                }
+        if(!all_patterns_matched)
+        {
+            continue;
+        }
 
-                string new_rule_match_str = enum_to_str(rule_app_dir, to_absolute_direction).value_or("error");
-                for(const auto& m : current_match_combination)
-                {
-                    new_rule_match_str += " ("+to_string(m.origin.x)+","+to_string(m.origin.y)+") ";
-                }
+        //go through every combination of one match per pattern, the last pattern being the one that changes the most often
+        for(int pattern_idx = 0; pattern_idx < pattern_count; ++pattern_idx)
+        {
+            m_match_combination_indexes_scratch[pattern_idx] = 0;
+            m_match_combination_scratch[pattern_idx] = m_pattern_matches_scratch[pattern_idx][0];
+        }
 
-                if(add_delta)
+        while(true)
+        {
+            RuleApplicationDelta application_delta = translate_rule_delta(rule, rule_app_dir, m_match_combination_scratch);
+
+            //do not add exactly identical deltas
+            //todo this could and should probably done by the compiler (altough maybe not all equalities could be caught by the compiler)
+            uint64_t delta_hash = application_delta.hash();
+            int identical_delta_idx = -1;
+            auto identical_hashes = m_rule_application_delta_hashes.equal_range(delta_hash);
+            for(auto it = identical_hashes.first; it != identical_hashes.second; ++it)
+            {
+                if(rule_delta.rule_application_deltas[it->second] == application_delta)
                 {
-                    PS_LOG("Matched the rule at "+new_rule_match_str);
-                    rule_delta.rule_application_deltas.push_back(application_delta);
+                    identical_delta_idx = it->second;
+                    break;
                 }
-                else
-                {
-                    PS_LOG("Skipping match at "+new_rule_match_str+" since it equals match at "+matched_delta_app_str);
+            }
 
-                }
+            if(identical_delta_idx == -1)
+            {
+                PS_LOG("Matched the rule at " + match_origins_to_string(rule_app_dir, application_delta.match_origins));
+                m_rule_application_delta_hashes.emplace(delta_hash, (int)rule_delta.rule_application_deltas.size());
+                rule_delta.rule_application_deltas.push_back(std::move(application_delta));
             }
             else
             {
-                //todo: for now only send the application position for the first pattern, this is a bit hacky
-                vector<PatternMatchInformation> matched_patterns = match_pattern(p_rule.match_patterns[rule_pattern_index], rule_app_dir, (rule_pattern_index == 0) ? application_positions : nullopt);
-
-                for(const auto& match : matched_patterns)
-                {
-                    vector<PatternMatchInformation> new_match_combination = current_match_combination;
-                    new_match_combination.push_back(match);
+                const RuleApplicationDelta& identical_delta = rule_delta.rule_application_deltas[identical_delta_idx];
+                PS_LOG("Skipping match at " + match_origins_to_string(rule_app_dir, application_delta.match_origins)
+                    + " since it equals match at " + match_origins_to_string(identical_delta.rule_direction, identical_delta.match_origins));
+            }
 
-                    compute_pattern_match_combinations(rule_pattern_index+1,new_match_combination);
-                }
+            int pattern_idx = pattern_count - 1;
+            while(pattern_idx >= 0 && ++m_match_combination_indexes_scratch[pattern_idx] >= m_pattern_matches_scratch[pattern_idx].size())
+            {
+                m_match_combination_indexes_scratch[pattern_idx] = 0;
+                m_match_combination_scratch[pattern_idx] = m_pattern_matches_scratch[pattern_idx][0];
+                --pattern_idx;
             }
 
-        };
+            if(pattern_idx < 0)
+            {
+                break;
+            }
 
-        compute_pattern_match_combinations(0, vector<PatternMatchInformation>());
+            m_match_combination_scratch[pattern_idx] = m_pattern_matches_scratch[pattern_idx][m_match_combination_indexes_scratch[pattern_idx]];
+        }
     }
 
     //todo check if there is collision between deltas
 
-    if(rule_delta.rule_application_deltas.size() > 0)
+    for(const RuleApplicationDelta& delta : rule_delta.rule_application_deltas)
     {
-        rule_delta.rule_applied = p_rule;
-        m_turn_history.subturns.back().steps.push_back(rule_delta);
+        apply_delta(delta);
     }
 
-    for(const RuleApplicationDelta& delta : rule_delta.rule_application_deltas)
+    const bool rule_applied = rule_delta.rule_application_deltas.size() > 0;
+
+    if(m_current_rule_stats != nullptr)
     {
-        apply_delta(delta);
+        m_current_rule_stats->applied_deltas += (int)rule_delta.rule_application_deltas.size();
+    }
+
+    if(rule_applied)
+    {
+        m_subturn_commands.insert(m_subturn_commands.end(), rule.commands.begin(), rule.commands.end());
+
+        if(m_config.record_turn_history)
+        {
+            rule_delta.rule_idx = p_rule_idx;
+            rule_delta.is_late_rule = p_is_late_rule;
+            m_turn_history.subturns.back().steps.push_back(std::move(rule_delta));
+        }
     }
+
+    return rule_applied;
 }
 
 void PSEngine::apply_delta(const RuleApplicationDelta& p_delta)
 {
     for(const ObjectDelta& obj_delta : p_delta.object_deltas)
     {
-        Cell* cell =  get_cell_at(obj_delta.cell_position);
+        const int cell_idx = obj_delta.cell_idx;
+        const int obj_id = obj_delta.object_id;
 
-        if(!obj_delta.object)
-        {
-            //should never happen, there's a nullptr object in a delta
-            assert(false);
-        }
-        else if(obj_delta.type == CompiledGame::ObjectDeltaType::None
+        if(obj_delta.type == CompiledGame::ObjectDeltaType::None
                 || obj_delta.type == CompiledGame::ObjectDeltaType::RelativeDown
                 || obj_delta.type == CompiledGame::ObjectDeltaType::RelativeUp
                 || obj_delta.type == CompiledGame::ObjectDeltaType::RelativeLeft
@@ -877,31 +1550,36 @@ void PSEngine::apply_delta(const RuleApplicationDelta& p_delta)
         }
         else if(obj_delta.type == CompiledGame::ObjectDeltaType::Appear)
         {
-            const auto& pair = cell->objects.find(obj_delta.object);
-            if(pair == cell->objects.end() )
+            if(!m_current_level.has_object(cell_idx, obj_id))
             {
-                cell->objects.insert(make_pair(obj_delta.object,ObjectMoveType::Stationary));
-                m_object_cache.add_object_position(obj_delta.object,cell->position);
+                m_current_level.add_object(cell_idx, obj_id);
+                m_current_level.set_movement(cell_idx, m_object_collision_layers[obj_id], ObjectMoveType::Stationary);
             }
             else
             {
-                string cell_coord_str = to_string(cell->position.x)+","+to_string(cell->position.y);
-                PS_LOG_ERROR("cannot add object " +obj_delta.object->identifier+ " since there's already one in the cell ("+cell_coord_str+")");
+                PSVector2i cell_position = m_current_level.get_cell_position(cell_idx);
+                string cell_coord_str = to_string(cell_position.x)+","+to_string(cell_position.y);
+                PS_LOG_ERROR("cannot add object " +m_compiled_game->primary_objects[obj_id]->identifier+ " since there's already one in the cell ("+cell_coord_str+")");
             }
             //todo check for collisions
         }
         else if(obj_delta.type == CompiledGame::ObjectDeltaType::Disappear)
         {
-            const auto& pair = cell->objects.find(obj_delta.object);
-            if(pair != cell->objects.end() )
+            if(m_current_level.has_object(cell_idx, obj_id))
             {
-                cell->objects.erase(pair);
-                m_object_cache.remove_object_position(obj_delta.object,cell->position);
+                m_current_level.remove_object(cell_idx, obj_id);
+                //the movement of the layer belonged to the removed object, it must not stay on an empty layer
+                const int col_layer = m_object_collision_layers[obj_id];
+                if(!m_collision_layer_masks[col_layer].intersects(m_current_level.get_cell_objects(cell_idx)))
+                {
+                    m_current_level.set_movement(cell_idx, col_layer, ObjectMoveType::Stationary);
+                }
             }
             else
             {
-                string cell_coord_str = to_string(cell->position.x)+","+to_string(cell->position.y);
-                PS_LOG_ERROR("cannot delete object " +obj_delta.object->identifier+ " since it wasn't on the cell ("+cell_coord_str+")");
+                PSVector2i cell_position = m_current_level.get_cell_position(cell_idx);
+                string cell_coord_str = to_string(cell_position.x)+","+to_string(cell_position.y);
+                PS_LOG_ERROR("cannot delete object " +m_compiled_game->primary_objects[obj_id]->identifier+ " since it wasn't on the cell ("+cell_coord_str+")");
             }
         }
         else
@@ -934,10 +1612,9 @@ void PSEngine::apply_delta(const RuleApplicationDelta& p_delta)
             }
 
 
-            const auto& pair = cell->objects.find(obj_delta.object);
-            if(pair != cell->objects.end() )
+            if(m_current_level.has_object(cell_idx, obj_id))
             {
-                pair->second = move_type;
+                m_current_level.set_movement(cell_idx, m_object_collision_layers[obj_id], move_type);
             }
         }
     }
@@ -948,79 +1625,95 @@ bool PSEngine::resolve_movements()
     return advanced_movement_resolution();
 }
 
-bool PSEngine::try_to_move_object(Cell& p_containing_cell, shared_ptr<CompiledGame::PrimaryObject> p_type_of_object_moved,RuleDelta& p_movement_deltas)
+int PSEngine::find_colliding_object(int p_cell_idx, int p_object_id) const
 {
-    std::pair<const shared_ptr<CompiledGame::PrimaryObject>,ObjectMoveType>* pair = nullptr;
+    const uint64_t* cell_objects = m_current_level.get_cell_objects(p_cell_idx);
+    const CompiledGame::ObjectMask& layer_mask = m_collision_layer_masks[m_object_collision_layers[p_object_id]];
 
-    for(auto& current_pair : p_containing_cell.objects )
+    for(int w = 0; w < m_current_level.object_words_per_cell; ++w)
     {
-        if(current_pair.first != p_type_of_object_moved)
+        uint64_t bits = cell_objects[w] & layer_mask.words[w];
+        if(bits != 0)
         {
-            continue;
+            return w*64 + pop_lowest_bit_index(bits);
         }
-
-        pair = &current_pair;
     }
 
-    if(pair != nullptr)
+    return -1;
+}
+
+bool PSEngine::try_to_move_object(int p_containing_cell_idx, int p_object_id, RuleDelta& p_movement_deltas)
+{
+    if(m_current_level.has_object(p_containing_cell_idx, p_object_id))
     {
-        if(pair->second == ObjectMoveType::Stationary || pair->second == ObjectMoveType::Action)
+        const int col_layer = m_object_collision_layers[p_object_id];
+        const ObjectMoveType move_type = m_current_level.get_movement(p_containing_cell_idx, col_layer);
+
+        if(move_type == ObjectMoveType::Stationary || move_type == ObjectMoveType::Action)
         {
             return false;
         }
         else
         {
-            assert(pair->second != ObjectMoveType::None); //an object move type is set to none, this should never happen
+            assert(move_type != ObjectMoveType::None); //an object move type is set to none, this should never happen
 
-            AbsoluteDirection dir = str_to_enum(enum_to_str(pair->second,to_object_move_type).value_or("error"), to_absolute_direction).value_or(AbsoluteDirection::None);
+            AbsoluteDirection dir = move_type_to_direction_table[move_type];
             assert(dir != AbsoluteDirection::None);//Could not convert ObjectMoveType to AbsoluteDirection. this should not happen
 
-            if( Cell* dest_cell = get_cell_from(p_containing_cell.position,1,dir))
+            int dest_cell_idx = get_cell_from(p_containing_cell_idx,1,dir);
+            if( dest_cell_idx != -1)
             {
-                shared_ptr<CompiledGame::PrimaryObject> found_object = pair->first;
-
                 //erase it preventively so it does not impede objects moving on this cell
                 //it will be readded if the move is impossible
-                p_containing_cell.objects.erase(pair->first);
+                m_current_level.remove_object(p_containing_cell_idx, p_object_id);
+                m_current_level.set_movement(p_containing_cell_idx, col_layer, ObjectMoveType::Stationary);
 
                 bool move_permitted = true;
 
-                auto colliding_object = dest_cell->find_colliding_object(found_object);
-                if(colliding_object.has_value())
+                int colliding_object = find_colliding_object(dest_cell_idx, p_object_id);
+                if(colliding_object != -1)
                 {
                     move_permitted = false;
 
-                    if(try_to_move_object(*dest_cell, colliding_object.value(), p_movement_deltas))
+                    if(try_to_move_object(dest_cell_idx, colliding_object, p_movement_deltas))
                     {
                         move_permitted = true;
                     }
                 }
 
-                MovementDelta move_delta;
-                move_delta.origin = p_containing_cell.position;
-                move_delta.destination = dest_cell->position;
-                move_delta.move_direction = dir;
-                move_delta.object = found_object;
-
+                if(m_config.collect_turn_stats)
+                {
+                    ++m_turn_stats.move_attempts;
+                    m_turn_stats.successful_moves += move_permitted ? 1 : 0;
+                }
 
                 if(move_permitted)
                 {
-                    move_delta.moved_successfully = true;
-                    dest_cell->objects.insert(make_pair(found_object, ObjectMoveType::Stationary));
+                    m_current_level.add_object(dest_cell_idx, p_object_id);
+                    m_current_level.set_movement(dest_cell_idx, col_layer, ObjectMoveType::Stationary);
                 }
                 else
                 {
-                    move_delta.moved_successfully = false;
-                    p_containing_cell.objects.insert(make_pair(found_object, ObjectMoveType::Stationary));
+                    m_current_level.add_object(p_containing_cell_idx, p_object_id);
                 }
-                p_movement_deltas.movement_deltas.push_back(move_delta);
-                return move_delta.moved_successfully;
+
+                if(m_config.record_turn_history)
+                {
+                    MovementDelta move_delta;
+                    move_delta.origin_cell_idx = p_containing_cell_idx;
+                    move_delta.destination_cell_idx = dest_cell_idx;
+                    move_delta.object_id = (PackedIndex)p_object_id;
+                    move_delta.move_direction = dir;
+                    move_delta.moved_successfully = move_permitted;
+                    p_movement_deltas.movement_deltas.push_back(move_delta);
+                }
+                return move_permitted;
 
             }
             else
             {
                 //movement was probably out of bounds, the movement of this object is impossible
-                pair->second = ObjectMoveType::Stationary;
+                m_current_level.set_movement(p_containing_cell_idx, col_layer, ObjectMoveType::Stationary);
                 return false;
             }
         }
@@ -1036,33 +1729,45 @@ bool PSEngine::advanced_movement_resolution()
     movement_deltas.is_movement_resolution = true;
 
 
-    for(Cell& cell : m_current_level.cells)
+    for(int i = 0; i < m_current_level.get_cell_count(); ++i)
     {
-        vector<shared_ptr<CompiledGame::PrimaryObject>> objects_to_move;
+        //the moving objects are gathered before any of them moves since moving an object can change the content of the cell
+        m_objects_to_move_scratch.clear();
 
-        for(auto& pair : cell.objects )
+        const uint64_t* cell_objects = m_current_level.get_cell_objects(i);
+        for(int w = 0; w < m_current_level.object_words_per_cell; ++w)
         {
-            if(pair.second == ObjectMoveType::Action)
-            {
-                //todo do we consider Action as a movement in the turn history ?
-                pair.second = ObjectMoveType::Stationary;
-            }
-            else if(pair.second != ObjectMoveType::Stationary)
+            uint64_t bits = cell_objects[w];
+            while(bits != 0)
             {
-                objects_to_move.push_back(pair.first);
+                const int obj_id = w*64 + pop_lowest_bit_index(bits);
+                const int col_layer = m_object_collision_layers[obj_id];
+                ObjectMoveType move_type = m_current_level.get_movement(i, col_layer);
+                if(move_type == ObjectMoveType::Action)
+                {
+                    //todo do we consider Action as a movement in the turn history ?
+                    m_current_level.set_movement(i, col_layer, ObjectMoveType::Stationary);
+                }
+                else if(move_type != ObjectMoveType::Stationary)
+                {
+                    m_objects_to_move_scratch.push_back(obj_id);
+                }
             }
         }
 
-        for(auto obj : objects_to_move)
+        for(int obj_id : m_objects_to_move_scratch)
         {
-            if( !try_to_move_object(cell, obj, movement_deltas) )
+            if( !try_to_move_object(i, obj_id, movement_deltas) )
             {
                 //should return false only if the player can't move ?
             }
         }
     }
 
-    m_turn_history.subturns.back().steps.push_back(movement_deltas);
+    if(m_config.record_turn_history)
+    {
+        m_turn_history.subturns.back().steps.push_back(std::move(movement_deltas));
+    }
 
     return true;
 }
@@ -1074,45 +1779,55 @@ bool PSEngine::basic_movement_resolution()
         PSVector2i origin;
         PSVector2i destination;
 
-        shared_ptr<CompiledGame::PrimaryObject> obj;
+        int obj_id;
     };
 
     vector<ObjectMoveInfo> objects_to_move;
 
-    for(Cell& cell : m_current_level.cells)
+    for(int i = 0; i < m_current_level.get_cell_count(); ++i)
     {
         vector<ObjectMoveInfo> current_cell_objects_to_move;
+        PSVector2i cell_position = m_current_level.get_cell_position(i);
 
-        for(auto& pair : cell.objects )
+        const uint64_t* cell_objects = m_current_level.get_cell_objects(i);
+        for(int w = 0; w < m_current_level.object_words_per_cell; ++w)
         {
-            if(pair.second == ObjectMoveType::Action)
-            {
-                pair.second = ObjectMoveType::Stationary;
-            }
-            else if(pair.second != ObjectMoveType::Stationary)
+            uint64_t bits = cell_objects[w];
+            while(bits != 0)
             {
-                if(pair.second == ObjectMoveType::None)
+                const int obj_id = w*64 + pop_lowest_bit_index(bits);
+                const int col_layer = m_object_collision_layers[obj_id];
+                ObjectMoveType move_type = m_current_level.get_movement(i, col_layer);
+                if(move_type == ObjectMoveType::Action)
                 {
-                    PS_LOG_ERROR("an objec move type is set to none, this should never happen");
-                    continue;
+                    m_current_level.set_movement(i, col_layer, ObjectMoveType::Stationary);
                 }
-                ObjectMoveInfo move_info;
-                move_info.origin = cell.position;
-                move_info.obj = pair.first;
-
-                //if some movement is invalid, the whole basic movement resolution is invalid
-                if( !get_move_destination_coord(cell.position,pair.second,move_info.destination))
+                else if(move_type != ObjectMoveType::Stationary)
                 {
-                    return false;
-                }
+                    if(move_type == ObjectMoveType::None)
+                    {
+                        PS_LOG_ERROR("an objec move type is set to none, this should never happen");
+                        continue;
+                    }
+                    ObjectMoveInfo move_info;
+                    move_info.origin = cell_position;
+                    move_info.obj_id = obj_id;
+
+                    //if some movement is invalid, the whole basic movement resolution is invalid
+                    if( !get_move_destination_coord(cell_position,move_type,move_info.destination))
+                    {
+                        return false;
+                    }
 
-                current_cell_objects_to_move.push_back(move_info);
+                    current_cell_objects_to_move.push_back(move_info);
+                }
             }
         }
 
         for(const auto& elem :current_cell_objects_to_move)
         {
-            cell.objects.erase(elem.obj);
+            m_current_level.remove_object(i, elem.obj_id);
+            m_current_level.set_movement(i, m_object_collision_layers[elem.obj_id], ObjectMoveType::Stationary);
 
             objects_to_move.push_back(elem);
         }
@@ -1121,42 +1836,45 @@ bool PSEngine::basic_movement_resolution()
     for(const auto& move_info : objects_to_move)
     {
         //check if object is not already in cell
-        Cell* dest_cell = get_cell_at(move_info.destination);
+        int dest_cell_idx = get_cell_at(move_info.destination);
 
-        if(dest_cell == nullptr)
+        if(dest_cell_idx == -1)
         {
             PS_LOG_ERROR("should not happen!");
             return false;
         }
 
-        if(dest_cell->objects.find(move_info.obj) != dest_cell->objects.end())
+        if(m_current_level.has_object(dest_cell_idx, move_info.obj_id))
         {
             //moving objects were temporarily removed from the level so only static ones should be detected here
             PS_LOG_ERROR("this object already exist in the destination cell, basic movement resolution cannot proceed.");
             return false;
         }
 
-        dest_cell->objects.insert(make_pair(move_info.obj, ObjectMoveType::Stationary));
-
+        m_current_level.add_object(dest_cell_idx, move_info.obj_id);
+        m_current_level.set_movement(dest_cell_idx, m_object_collision_layers[move_info.obj_id], ObjectMoveType::Stationary);
     }
 
     //check if there's no collisions
-    for(Cell& cell : m_current_level.cells)
+    for(int i = 0; i < m_current_level.get_cell_count(); ++i)
     {
-        if(cell.objects.size() <= 1)
-        {
-            continue;
-        }
-
-        set<shared_ptr<CompiledGame::CollisionLayer>> current_col_layers;
-
-        for(auto& pair : cell.objects )
+        const uint64_t* cell_objects = m_current_level.get_cell_objects(i);
+        for(const CompiledGame::ObjectMask& layer_mask : m_collision_layer_masks)
         {
-            if( current_col_layers.count(pair.first->collision_layer.lock()) != 0)
+            int layer_object_count = 0;
+            for(int w = 0; w < m_current_level.object_words_per_cell; ++w)
+            {
+                uint64_t bits = cell_objects[w] & layer_mask.words[w];
+                while(bits != 0)
+                {
+                    pop_lowest_bit_index(bits);
+                    ++layer_object_count;
+                }
+            }
+            if(layer_object_count > 1)
             {
                 return false; //collision was detected;
             }
-            current_col_layers.insert(pair.first->collision_layer.lock());
         }
     }
 
@@ -1165,9 +1883,14 @@ bool PSEngine::basic_movement_resolution()
 
  bool PSEngine::check_win_conditions()
  {
-    for(const CompiledGame::WinCondition& win_condition : m_compiled_game.win_conditions)
+    for(int i = 0; i < m_compiled_game->win_conditions.size(); ++i)
     {
-        if(!check_win_condition(win_condition))
+        if(m_config.collect_turn_stats)
+        {
+            ++m_turn_stats.win_condition_checks;
+        }
+
+        if(!check_win_condition(i))
         {
             return false;
         }
@@ -1175,87 +1898,72 @@ bool PSEngine::basic_movement_resolution()
     return true;
  }
 
-bool PSEngine::check_win_condition(const CompiledGame::WinCondition& p_win_condition)
+bool PSEngine::check_win_condition(int p_win_condition_idx)
 {
-    for(const auto & cell : m_current_level.cells)
-    {
+    const CompiledGame::WinCondition& win_condition = m_compiled_game->win_conditions[p_win_condition_idx];
+    const CompiledGame::ObjectMask& object_mask = m_win_condition_masks[p_win_condition_idx].first;
+    const CompiledGame::ObjectMask& on_object_mask = m_win_condition_masks[p_win_condition_idx].second;
 
-        bool on_object_found = p_win_condition.on_object == nullptr;
-        bool object_found = false;
-        for(const auto& cell_content : cell.objects)
-        {
-            if(!on_object_found && p_win_condition.on_object->defines(cell_content.first))
-            {
-                on_object_found = true;
-            }
-            if(p_win_condition.object->defines(cell_content.first))
-            {
-                object_found = true;
-            }
-        }
+    //every win condition only depends on the cells containing the object
+    m_current_level.get_cells_containing(object_mask, m_win_condition_cells_scratch);
 
-        switch (p_win_condition.type)
+    for(int w = 0; w < m_win_condition_cells_scratch.size(); ++w)
+    {
+        uint64_t cells_bits = m_win_condition_cells_scratch[w];
+        while(cells_bits != 0)
         {
-        case CompiledGame::WinConditionType::Some:
-            if(on_object_found && object_found)
-            {
-                return true;
-            }
-            break;
-        case CompiledGame::WinConditionType::No:
-            if(on_object_found && object_found)
-            {
-                return false;
-            }
-            break;
-        case CompiledGame::WinConditionType::All:
-            if(object_found && !on_object_found)
+            const uint64_t* cell_objects = m_current_level.get_cell_objects(w*64 + pop_lowest_bit_index(cells_bits));
+            bool on_object_found = win_condition.on_object == nullptr || on_object_mask.intersects(cell_objects);
+
+            switch (win_condition.type)
             {
-                return false;
+            case CompiledGame::WinConditionType::Some:
+                if(on_object_found)
+                {
+                    return true;
+                }
+                break;
+            case CompiledGame::WinConditionType::No:
+                if(on_object_found)
+                {
+                    return false;
+                }
+                break;
+            case CompiledGame::WinConditionType::All:
+                if(!on_object_found)
+                {
+                    return false;
+                }
+                break;
+            default:
+                PS_LOG_ERROR("should not happen");
+                break;
             }
-            break;
-        default:
-            PS_LOG_ERROR("should not happen");
-            break;
         }
     }
+
     return true;
 }
 
-set<PSEngine::AbsoluteDirection> PSEngine::get_absolute_directions_from_rule_direction(CompiledGame::RuleDirection p_rule_direction)
+const vector<PSEngine::AbsoluteDirection>& PSEngine::get_absolute_directions_from_rule_direction(CompiledGame::RuleDirection p_rule_direction)
 {
-    set<AbsoluteDirection> results;
     switch (p_rule_direction)
     {
     case CompiledGame::RuleDirection::Up:
-        results.insert(AbsoluteDirection::Up);
-        break;
+        return up_absolute_direction;
     case CompiledGame::RuleDirection::Down:
-        results.insert(AbsoluteDirection::Down);
-        break;
+        return down_absolute_direction;
     case CompiledGame::RuleDirection::Left:
-        results.insert(AbsoluteDirection::Left);
-        break;
+        return left_absolute_direction;
     case CompiledGame::RuleDirection::Right:
-        results.insert(AbsoluteDirection::Right);
-        break;
+        return right_absolute_direction;
     case CompiledGame::RuleDirection::Horizontal:
-        results.insert(AbsoluteDirection::Left);
-        results.insert(AbsoluteDirection::Right);
-        break;
+        return horizontal_absolute_directions;
     case CompiledGame::RuleDirection::Vertical:
-        results.insert(AbsoluteDirection::Up);
-        results.insert(AbsoluteDirection::Down);
-        break;
+        return vertical_absolute_directions;
     default:
-        results.insert(AbsoluteDirection::Up);
-        results.insert(AbsoluteDirection::Down);
-        results.insert(AbsoluteDirection::Left);
-        results.insert(AbsoluteDirection::Right);
-        break;
+        return all_absolute_directions;
     }
-
-    return results;
 }
 
 bool PSEngine::get_move_destination_coord(PSVector2i p_origin, ObjectMoveType p_move_type, PSVector2i& p_out_destination)
@@ -1291,85 +1999,36 @@ bool PSEngine::get_move_destination_coord(PSVector2i p_origin, ObjectMoveType p_
     return true;
 }
 
-PSEngine::Cell* PSEngine::get_cell_from(PSVector2i p_origin, int p_distance, AbsoluteDirection p_direction)
-{
-    if(p_distance == 0)
-    {
-        return get_cell_at(p_origin);
-    }
-    else
-    {
-        switch (p_direction)
-        {
-        case AbsoluteDirection::Up:
-            return get_cell_from(p_origin + PSVector2i(0,-1),p_distance-1,p_direction);
-
-        case AbsoluteDirection::Down:
-            return get_cell_from(p_origin + PSVector2i(0,1),p_distance-1,p_direction);
-
-        case AbsoluteDirection::Left:
-            return get_cell_from(p_origin + PSVector2i(-1,0),p_distance-1,p_direction);
-
-        case AbsoluteDirection::Right:
-            return get_cell_from(p_origin + PSVector2i(1,0),p_distance-1,p_direction);
-
-
-        default:
-            break;
-        }
-    }
-
-    PS_LOG_ERROR("should not happen");
-    return nullptr;
-}
-
-PSEngine::Cell* PSEngine::get_cell_at(PSVector2i p_position)
-{
-    //check for out of bounds
-    if(p_position.x >= m_current_level.size.x || p_position.x < 0 || p_position.y >= m_current_level.size.y || p_position.y < 0)
-    {
-        //PS_LOG_ERROR("Cannot get move destination cell since the move would be out of bounds");
-        return nullptr;
-    }
-
-    return &m_current_level.cells[p_position.x + p_position.y*m_current_level.size.x];
-}
-
-PSEngine::Cell* PSEngine::get_cell_at(int p_index)
+int PSEngine::get_cell_at(PSVector2i p_position)
 {
-    return get_cell_at(PSVector2i(p_index % m_current_level.size.x, p_index / m_current_level.size.x));
+    return m_current_level.get_cell_index(p_position);
 }
 
 void PSEngine::load_level_internal(int p_level_idx)
 {
-    if(p_level_idx >= m_compiled_game.levels.size())
+    if(p_level_idx >= m_compiled_game->levels.size())
     {
-        PS_LOG_ERROR("Cannot load level "+to_string(p_level_idx)+", there's only "+to_string(m_compiled_game.levels.size())+" levels.");
+        PS_LOG_ERROR("Cannot load level "+to_string(p_level_idx)+", there's only "+to_string(m_compiled_game->levels.size())+" levels.");
         return;
     }
-    m_level_state_stack.clear();
+    m_undo_changes.clear();
+    m_undo_turns_change_counts.clear();
     m_is_level_won = false;
     m_current_tick_time_elapsed = 0;
 
-    CompiledGame::Level compiled_level = m_compiled_game.levels[p_level_idx];
+    const CompiledGame::Level& compiled_level = m_compiled_game->levels[p_level_idx];
 
     m_current_level = Level();
+    invalidate_rules_read_infos();
+    m_current_level.init(p_level_idx, PSVector2i(compiled_level.width, compiled_level.height), (int)m_compiled_game->primary_objects.size(), m_collision_layer_count);
 
-    m_current_level.level_idx = p_level_idx;
-    m_current_level.size = PSVector2i(compiled_level.width, compiled_level.height);
-
-
-    for(int i = 0; i < compiled_level.cells.size(); ++i)
+    //cells past width*height (ie: a last row that was not closed by a return) are not part of the level
+    int cell_count = std::min((int)compiled_level.cells.size(), m_current_level.get_cell_count());
+    for(int i = 0; i < cell_count; ++i)
     {
-        const auto& cell = compiled_level.cells[i];
-
-        m_current_level.cells.push_back(Cell());
-
-        m_current_level.cells.back().position = PSVector2i( i % m_current_level.size.x, i / m_current_level.size.x);
-
-        for(weak_ptr<CompiledGame::PrimaryObject> obj : cell.objects)
+        for(int obj_id : compiled_level.cells[i].object_ids)
         {
-            m_current_level.cells.back().objects.insert(make_pair(obj.lock(),ObjectMoveType::Stationary));
+            m_current_level.add_object(i, obj_id);
         }
     }
 }
@@ -1380,7 +2039,7 @@ void PSEngine::load_next_level()
 
     Operation op = Operation(OperationType::LoadLevel);
     op.loaded_level = next_level_idx;
-    m_operation_history.push_back(op);
+    record_operation(op);
 
     load_level_internal(next_level_idx);
 }
@@ -1389,7 +2048,7 @@ void PSEngine::load_level(int p_level_idx)
 {
     Operation op = Operation(OperationType::LoadLevel);
     op.loaded_level = p_level_idx;
-    m_operation_history.push_back(op);
+    record_operation(op);
 
     load_level_internal(p_level_idx);
 }
@@ -1401,6 +2060,11 @@ bool PSEngine::is_level_won() const
 
 void PSEngine::print_game_state()
 {
+    if(!is_log_enabled(PSLogger::LogType::Log))
+    {
+        return;
+    }
+
     string print_result_str = "\n";
 
     const int cell_draw_size = 2;
@@ -1409,7 +2073,7 @@ void PSEngine::print_game_state()
 
     vector<string> lines_to_draw;
 
-    if(m_current_level.cells.size() != height*width)
+    if(m_current_level.get_cell_count() != height*width)
     {
         PS_LOG_ERROR("Cannot print level, height and width do not match with the number of cells");
     }
@@ -1444,20 +2108,20 @@ void PSEngine::print_game_state()
 
         for(int x = 0; x < width; ++x)
         {
-            const Cell& cell = m_current_level.cells[y*width+x];
+            vector<int> cell_objects = m_current_level.get_objects_in_cell(y*width+x);
 
             const int draw_space = cell_draw_size*cell_draw_size;
             int draw_idx = 0;
 
-            if(cell.objects.size() > draw_space)
+            if(cell_objects.size() > draw_space)
             {
-                PS_LOG_ERROR("Will not be able to draw correctly level. Too many objects in a cell and too little size to draw ("+to_string(cell.objects.size())+" vs "+to_string(draw_space)+")" );
+                PS_LOG_ERROR("Will not be able to draw correctly level. Too many objects in a cell and too little size to draw ("+to_string(cell_objects.size())+" vs "+to_string(draw_space)+")" );
                 return;
             }
 
-            for(auto& obj : cell.objects)
+            for(int obj_id : cell_objects)
             {
-                string alias = get_single_char_obj_alias(obj.first->identifier);
+                string alias = get_single_char_obj_alias(m_compiled_game->primary_objects[obj_id]->identifier);
 
                 const int line_idx = draw_idx / cell_draw_size;
 
@@ -1499,7 +2163,7 @@ string PSEngine::get_single_char_obj_alias(const string& p_obj_id)
         return try_find_in_cache->second;
     }
 
-    for(const auto& obj : m_compiled_game.objects)
+    for(const auto& obj : m_compiled_game->objects)
     {
         auto alias_obj = obj->as_alias_object();
         if(!alias_obj)
@@ -1564,8 +2228,38 @@ void PSEngine::print_operation_history() const
     PS_LOG(operation_history_to_string());
 }
 
+string PSEngine::turn_stats_to_string() const
+{
+    auto rules_stats_to_string = [](const vector<CompiledGame::Rule>& p_rules, const vector<RuleStats>& p_rules_stats)
+    {
+        string result = "";
+        for(int i = 0; i < p_rules_stats.size(); ++i)
+        {
+            const RuleStats& stats = p_rules_stats[i];
+            result += "\t" + to_string(stats.evaluations) + " evaluations, " + to_string(stats.skips) + " skips, ";
+            result += to_string(stats.candidate_cells) + " candidate cells, " + to_string(stats.matches) + " matches, ";
+            result += to_string(stats.applied_deltas) + " applied deltas, " + to_string(stats.duration_ns) + " ns : ";
+            result += p_rules[i].to_string() + "\n";
+        }
+        return result;
+    };
+
+    string result = "Turn stats : " + to_string(m_turn_stats.subturns) + " subturns in " + to_string(m_turn_stats.turn_duration_ns) + " ns\n";
+    result += "Rules\n" + rules_stats_to_string(m_compiled_game->rules, m_turn_stats.rules);
+    result += "Late rules\n" + rules_stats_to_string(m_compiled_game->late_rules, m_turn_stats.late_rules);
+    result += "Movement : " + to_string(m_turn_stats.movement_resolutions) + " resolutions, " + to_string(m_turn_stats.move_attempts) + " move attempts, ";
+    result += to_string(m_turn_stats.successful_moves) + " successful moves, " + to_string(m_turn_stats.movement_duration_ns) + " ns\n";
+    result += "Win conditions : " + to_string(m_turn_stats.win_condition_checks) + " checks, " + to_string(m_turn_stats.win_conditions_duration_ns) + " ns\n";
+    return result;
+}
+
 void PSEngine::print_subturns_history() const
 {
+    if(!is_log_enabled(PSLogger::LogType::Log))
+    {
+        return;
+    }
+
     string result = "";
     for(int i = 0; i < m_turn_history.subturns.size(); ++i)
     {
@@ -1578,29 +2272,26 @@ void PSEngine::print_subturns_history() const
                 result += "Movement Resolution\n";
                 for(const auto& move_delta : rule_delta.movement_deltas)
                 {
+                    PSVector2i origin = m_current_level.get_cell_position(move_delta.origin_cell_idx);
+                    PSVector2i destination = m_current_level.get_cell_position(move_delta.destination_cell_idx);
                     result += "\t";
-                    result += (move_delta.object.get() != nullptr ? move_delta.object->identifier : "nullptr") + " ";
+                    result += m_compiled_game->primary_objects[move_delta.object_id]->identifier + " ";
                     result += "moved " + enum_to_str(move_delta.move_direction,to_absolute_direction).value_or("ERROR");
-                    result += " from ("+ to_string(move_delta.origin.x)+","+to_string(move_delta.origin.y);
-                    result += ") to ("+to_string(move_delta.destination.x)+","+to_string(move_delta.destination.y)+")\n";
+                    result += " from ("+ to_string(origin.x)+","+to_string(origin.y);
+                    result += ") to ("+to_string(destination.x)+","+to_string(destination.y)+")\n";
                 }
             }
             else
             {
-                result += rule_delta.rule_applied.to_string()+"\n";
+                result += get_rule(rule_delta.rule_idx, rule_delta.is_late_rule).to_string()+"\n";
                 for(const auto& rule_app_delta : rule_delta.rule_application_deltas)
                 {
-                    string rule_match_str = enum_to_str(rule_app_delta.rule_direction, to_absolute_direction).value_or("error");
-                    for(const auto& m : rule_app_delta.match_infos)
-                    {
-                        rule_match_str += " ("+to_string(m.origin.x)+","+to_string(m.origin.y)+") ";
-                    }
-
-                    result += "\t" + rule_match_str + "\n";
+                    result += "\t" + match_origins_to_string(rule_app_delta.rule_direction, rule_app_delta.match_origins) + "\n";
                     for(const auto& object_delta : rule_app_delta.object_deltas)
                     {
-                        result += "\t\t" + to_string(object_delta.cell_position.x)+","+to_string(object_delta.cell_position.y)+" ";
-                        result += (object_delta.object.get() != nullptr ? object_delta.object->identifier : "nullptr") + " ";
+                        PSVector2i cell_position = m_current_level.get_cell_position(object_delta.cell_idx);
+                        result += "\t\t" + to_string(cell_position.x)+","+to_string(cell_position.y)+" ";
+                        result += m_compiled_game->primary_objects[object_delta.object_id]->identifier + " ";
                         result += enum_to_str(object_delta.type,CompiledGame::to_object_delta_type).value_or("ERROR") + "\n";
                     }
                 }
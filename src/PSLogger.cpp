@@ -3,9 +3,9 @@
 
 #include "PSLogger.hpp"
 
-void PSLogger::log(LogType p_type, std::string p_category, std::string p_msg)
+void PSLogger::log(LogType p_type, const std::string& p_category, const std::string& p_msg)
 {
-    if(p_type < log_verbosity )
+    if(!is_enabled(p_type))
     {
         return;
     }
@@ -0,0 +1,368 @@
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+#include "PSSolver.hpp"
+
+using namespace std;
+
+//number of nodes a worker claims at once from a work range
+static const size_t EXPANSION_CHUNK_SIZE = 16;
+
+const string PSSolver::m_solver_log_cat = "solver";
+
+std::map<string,PSSolver::Status, ci_less> PSSolver::to_status = {
+    {"Solved",Status::Solved},
+    {"Unsolvable",Status::Unsolvable},
+    {"LimitReached",Status::LimitReached},
+    {"InvalidLevel",Status::InvalidLevel},
+};
+
+PSSolver::PSSolver(shared_ptr<const CompiledGame> p_game, shared_ptr<PSLogger> p_logger /*= nullptr*/) : PSSolver(std::move(p_game), Config(), p_logger){}
+
+PSSolver::PSSolver(shared_ptr<const CompiledGame> p_game, Config p_config, shared_ptr<PSLogger> p_logger /*= nullptr*/)
+: m_config(p_config), m_logger(p_logger), m_compiled_game(std::move(p_game)), m_visited_shards(VISITED_SHARD_COUNT)
+{
+    if(m_logger == nullptr)
+    {
+        cout << "A Logger ptr was not passed to the solver constructor, construction a default one\n";
+        m_logger = make_shared<PSLogger>(PSLogger());
+    }
+
+    if(m_config.thread_count <= 0)
+    {
+        m_config.thread_count = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+
+    //the engines only play turns, nothing is logged or recorded
+    PSEngine::Config engine_config;
+    engine_config.log_verbosity = PSLogger::LogType::Critical;
+    engine_config.log_operation_history_after_error = false;
+    engine_config.undo_max_turns = 1;
+    engine_config.record_turn_history = false;
+    engine_config.record_operation_history = false;
+
+    shared_ptr<PSLogger> engine_logger = make_shared<PSLogger>();
+    engine_logger->log_verbosity = PSLogger::LogType::Critical;
+
+    m_workers.resize(m_config.thread_count);
+    for(Worker& worker : m_workers)
+    {
+        worker.engine = make_unique<PSEngine>(engine_config, engine_logger);
+        worker.engine->load_game(m_compiled_game);
+    }
+}
+
+PSSolver::Result PSSolver::solve_level(int p_level_idx)
+{
+    Result result;
+    result.level_idx = p_level_idx;
+
+    if(m_compiled_game == nullptr || p_level_idx < 0 || p_level_idx >= m_compiled_game->levels.size())
+    {
+        PS_LOGGER_LOG(m_logger, PSLogger::LogType::Error, m_solver_log_cat, "Cannot solve level " + to_string(p_level_idx) + ", it does not exist.");
+        return result;
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    for(Worker& worker : m_workers)
+    {
+        worker.engine->load_level(p_level_idx);
+        worker.children.clear();
+        worker.solution = nullptr;
+    }
+
+    const PSEngine::Level& start_level = m_workers[0].engine->get_current_level();
+    m_object_word_count = (int)start_level.objects.size();
+    m_content_word_count = m_object_word_count + (int)(start_level.movements.size() + sizeof(uint64_t) - 1)/sizeof(uint64_t);
+
+    clear_visited_states();
+    m_solution_found = false;
+    m_limit_reached = false;
+    m_depth_limit_reached = false;
+
+    vector<uint64_t> start_content;
+    copy_level_content(start_level, start_content);
+    const Node* start_node = visit_state(std::move(start_content), start_level.state_hash, false, nullptr, PSEngine::InputType::None, 0, 0);
+
+    //the nodes to expand grouped by cost, for a breadth first search the cost is the depth so every group is a layer of the search
+    map<int, vector<const Node*>> open_nodes;
+    open_nodes[start_node->cost].push_back(start_node);
+
+    const Node* solution = nullptr;
+    while(!open_nodes.empty() && solution == nullptr && !m_limit_reached)
+    {
+        vector<const Node*> nodes = std::move(open_nodes.begin()->second);
+        open_nodes.erase(open_nodes.begin());
+
+        for(const Node* node : nodes)
+        {
+            result.explored_depth = std::max(result.explored_depth, node->depth);
+        }
+
+        int worker_count = (int)std::min((size_t)m_config.thread_count, (nodes.size() + EXPANSION_CHUNK_SIZE - 1)/EXPANSION_CHUNK_SIZE);
+        m_work_ranges.clear();
+        for(int i = 0; i < worker_count; ++i)
+        {
+            m_work_ranges.emplace_back();
+            m_work_ranges.back().next = nodes.size()*i/worker_count;
+            m_work_ranges.back().end = nodes.size()*(i+1)/worker_count;
+        }
+
+        //the calling thread is the first worker
+        vector<std::thread> threads;
+        for(int i = 1; i < worker_count; ++i)
+        {
+            threads.emplace_back(&PSSolver::expand_nodes, this, i, std::cref(nodes));
+        }
+        expand_nodes(0, nodes);
+        for(std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        for(Worker& worker : m_workers)
+        {
+            if(worker.solution != nullptr && (solution == nullptr || worker.solution->depth < solution->depth))
+            {
+                solution = worker.solution;
+            }
+
+            for(const Node* child : worker.children)
+            {
+                open_nodes[child->cost].push_back(child);
+            }
+            worker.children.clear();
+            worker.solution = nullptr;
+        }
+    }
+
+    if(solution != nullptr)
+    {
+        result.status = Status::Solved;
+        result.solution = get_solution_inputs(solution);
+        result.explored_depth = solution->depth;
+    }
+    else if(m_limit_reached || m_depth_limit_reached)
+    {
+        result.status = Status::LimitReached;
+    }
+    else
+    {
+        result.status = Status::Unsolvable;
+    }
+
+    result.visited_states = m_visited_state_count;
+    result.duration_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count();
+
+    //the visited states are only needed during the search
+    clear_visited_states();
+
+    PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_solver_log_cat, "Level " + to_string(p_level_idx) + " : " + enum_to_str(result.status, to_status).value_or("ERROR")
+        + (result.status == Status::Solved ? " in " + to_string(result.solution.size()) + " inputs" : "")
+        + ", " + to_string(result.visited_states) + " states visited.");
+
+    return result;
+}
+
+vector<PSSolver::Result> PSSolver::solve_all_levels()
+{
+    vector<Result> results;
+    for(int i = 0; i < m_compiled_game->levels.size(); ++i)
+    {
+        results.push_back(solve_level(i));
+    }
+    return results;
+}
+
+void PSSolver::expand_nodes(int p_worker_idx, const vector<const Node*>& p_nodes)
+{
+    Worker& worker = m_workers[p_worker_idx];
+
+    for(int r = 0; r < m_work_ranges.size(); ++r)
+    {
+        WorkRange& range = m_work_ranges[(p_worker_idx + r) % m_work_ranges.size()];
+        while(!m_solution_found && !m_limit_reached)
+        {
+            size_t begin = range.next.fetch_add(EXPANSION_CHUNK_SIZE);
+            if(begin >= range.end)
+            {
+                break;
+            }
+
+            size_t end = std::min(begin + EXPANSION_CHUNK_SIZE, range.end);
+            for(size_t i = begin; i < end && !m_solution_found && !m_limit_reached; ++i)
+            {
+                expand_node(worker, p_nodes[i]);
+            }
+        }
+    }
+}
+
+void PSSolver::expand_node(Worker& p_worker, const Node* p_node)
+{
+    if(m_config.max_solution_length > 0 && p_node->depth >= m_config.max_solution_length)
+    {
+        m_depth_limit_reached = true;
+        return;
+    }
+
+    PSEngine& engine = *p_worker.engine;
+    const uint8_t* node_movements = reinterpret_cast<const uint8_t*>(p_node->content.data() + m_object_word_count);
+
+    for(PSEngine::InputType input : m_config.inputs)
+    {
+        engine.restore_level_content(p_node->content.data(), node_movements);
+        engine.receive_input(input);
+
+        vector<uint64_t> child_content;
+        copy_level_content(engine.get_current_level(), child_content);
+
+        int child_cost = p_node->depth + 1;
+        if(m_config.search_type == SearchType::AStar)
+        {
+            child_cost += engine.get_win_conditions_distance();
+        }
+
+        const Node* child = visit_state(std::move(child_content), engine.get_level_hash(), engine.is_level_won(), p_node, input, p_node->depth + 1, child_cost);
+        if(child == nullptr)
+        {
+            continue;
+        }
+
+        if(engine.is_level_won())
+        {
+            p_worker.solution = child;
+            m_solution_found = true;
+            return;
+        }
+
+        p_worker.children.push_back(child);
+    }
+}
+
+const PSSolver::Node* PSSolver::visit_state(vector<uint64_t>&& p_content, uint64_t p_hash, bool p_is_won, const Node* p_parent, PSEngine::InputType p_input, int p_depth, int p_cost)
+{
+    VisitedShard& shard = m_visited_shards[p_hash % VISITED_SHARD_COUNT];
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto range = shard.nodes_by_hash.equal_range(p_hash);
+    for(auto it = range.first; it != range.second; ++it)
+    {
+        if(it->second->is_won == p_is_won && it->second->content == p_content)
+        {
+            return nullptr;
+        }
+    }
+
+    if(m_config.max_visited_states > 0 && m_visited_state_count >= m_config.max_visited_states)
+    {
+        m_limit_reached = true;
+        return nullptr;
+    }
+    ++m_visited_state_count;
+
+    shard.nodes.emplace_back();
+    Node& node = shard.nodes.back();
+    node.content = std::move(p_content);
+    node.hash = p_hash;
+    node.is_won = p_is_won;
+    node.parent = p_parent;
+    node.input = p_input;
+    node.depth = p_depth;
+    node.cost = p_cost;
+
+    shard.nodes_by_hash.emplace(p_hash, &node);
+    return &node;
+}
+
+void PSSolver::clear_visited_states()
+{
+    for(VisitedShard& shard : m_visited_shards)
+    {
+        shard.nodes.clear();
+        shard.nodes_by_hash.clear();
+    }
+    m_visited_state_count = 0;
+}
+
+void PSSolver::copy_level_content(const PSEngine::Level& p_level, vector<uint64_t>& p_out_content) const
+{
+    p_out_content.assign(m_content_word_count, 0);
+    std::copy(p_level.objects.begin(), p_level.objects.end(), p_out_content.begin());
+    std::memcpy(p_out_content.data() + m_object_word_count, p_level.movements.data(), p_level.movements.size());
+}
+
+vector<PSEngine::InputType> PSSolver::get_solution_inputs(const Node* p_node) const
+{
+    vector<PSEngine::InputType> inputs;
+    for(const Node* node = p_node; node->parent != nullptr; node = node->parent)
+    {
+        inputs.push_back(node->input);
+    }
+    std::reverse(inputs.begin(), inputs.end());
+    return inputs;
+}
+
+char PSSolver::input_to_record_char(PSEngine::InputType p_input)
+{
+    switch (p_input)
+    {
+    case PSEngine::InputType::Up:
+        return 'z';
+    case PSEngine::InputType::Down:
+        return 's';
+    case PSEngine::InputType::Left:
+        return 'q';
+    case PSEngine::InputType::Right:
+        return 'd';
+    case PSEngine::InputType::Action:
+        return 'e';
+    default:
+        return 0;
+    }
+}
+
+bool PSSolver::write_test_record(const string& p_record_file_path, const string& p_game_file_name, const vector<Result>& p_results)
+{
+    ofstream record_file;
+    record_file.open(p_record_file_path, ios::out | ios::trunc);
+    if(!record_file.is_open())
+    {
+        return false;
+    }
+
+    record_file << "format version " << TEST_RECORD_VERSION << "\n";
+    record_file << p_game_file_name << "\n";
+
+    for(const Result& result : p_results)
+    {
+        if(result.status == Status::InvalidLevel)
+        {
+            continue;
+        }
+
+        record_file << result.level_idx << "\n";
+        if(result.status == Status::Solved)
+        {
+            for(PSEngine::InputType input : result.solution)
+            {
+                record_file << input_to_record_char(input) << "\n";
+            }
+            record_file << "won\n";
+        }
+        else
+        {
+            record_file << "notwon\n";
+        }
+    }
+
+    record_file.close();
+    return true;
+}
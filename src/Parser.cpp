@@ -27,13 +27,13 @@ const string Parser::m_parser_log_cat = "parser";
 
 std::optional<ParsedGame> Parser::parse_from_file(string p_file_path, shared_ptr<PSLogger> p_logger)
 {
-	unique_ptr<TextProvider> txt_provider(new TextProviderFile(p_logger,p_file_path));
+	unique_ptr<TextProvider> txt_provider(new TextProviderMappedFile(p_logger,p_file_path));
 	return parse_from_text_provider(move(txt_provider),p_logger);
 }
 
 std::optional<ParsedGame> Parser::parse_from_string(string p_text, shared_ptr<PSLogger> p_logger)
 {
-	unique_ptr<TextProvider> txt_provider(new TextProviderString(p_logger,p_text));
+	unique_ptr<TextProvider> txt_provider(new TextProviderString(p_logger,std::move(p_text)));
 	return parse_from_text_provider(move(txt_provider),p_logger);
 }
 
@@ -61,6 +61,7 @@ Parser::~Parser()
 std::optional<ParsedGame> Parser::parse_file()
 {
 	m_parsed_game = ParsedGame();
+	m_parsed_game.source = make_shared<ParsedGame::Source>();
 
 	if(m_line_counter != 1)
 	{
@@ -71,11 +72,21 @@ std::optional<ParsedGame> Parser::parse_file()
 
 	if(m_text_provider->is_valid())
 	{
-		m_logger->log(PSLogger::LogType::Log, m_parser_log_cat, "Parsing file");
+		PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_parser_log_cat, "Parsing file");
+
+		m_text = m_text_provider->get_text();
+
+		//the whole text is checked once instead of on every advance
+		auto non_ascii_char = std::find_if(m_text.begin(), m_text.end(), [](char c){return static_cast<unsigned char>(c) > 127;});
+		if(non_ascii_char != m_text.end())
+		{
+			m_line_counter = 1 + (int)std::count(m_text.begin(), non_ascii_char, '\n');
+			detect_error("detected non ascii character. this interpreter does not yet support unicode files, sorry :/");
+		}
 
 		m_current_file_section = FileSection::Prelude;
 
-		while(m_text_provider->is_valid() && !m_has_error)
+		while(is_text_valid() && !m_has_error)
 		{
 			switch (m_current_file_section)
 			{
@@ -116,7 +127,10 @@ std::optional<ParsedGame> Parser::parse_file()
 			}
 		}
 
-		return  std::optional<ParsedGame>(m_parsed_game);
+		//the tokens point into the text of the provider, the parsed game keeps it alive
+		m_parsed_game.source->text_provider = std::move(m_text_provider);
+
+		return  std::optional<ParsedGame>(std::move(m_parsed_game));
 	}
 	else
 	{
@@ -128,20 +142,20 @@ std::optional<ParsedGame> Parser::parse_file()
 
 void Parser::try_change_file_section(FileSection p_new_file_section)
 {
-	m_logger->log(PSLogger::LogType::Log, m_parser_log_cat, "Changing Section -------------------------" + enum_to_str(p_new_file_section,to_file_section).value_or("error converting string"));
+	PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_parser_log_cat, "Changing Section -------------------------" + enum_to_str(p_new_file_section,to_file_section).value_or("error converting string"));
 	m_current_file_section = p_new_file_section;
 	//check that sections are in the correct order;
 }
 
 void Parser::parse_prelude()
 {
-	m_logger->log(PSLogger::LogType::Log, m_parser_log_cat, "Starting prelude parsing");
+	PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_parser_log_cat, "Starting prelude parsing");
 
 	bool line_beggining = true;
 
-	while(m_text_provider->is_valid() && m_current_file_section == FileSection::Prelude)
+	while(is_text_valid() && m_current_file_section == FileSection::Prelude)
 	{
-		m_text_provider->advance();
+		advance();
 		if(try_parse_return())
 		{
 			m_line_counter ++;
@@ -149,7 +163,7 @@ void Parser::parse_prelude()
 		}
 		else
 		{
-			switch(m_text_provider->get_current_char())
+			switch(current_char())
 			{
 				case '=':
 				//ignore '=' character
@@ -176,12 +190,12 @@ void Parser::parse_prelude()
 
 	}
 
-	m_logger->log(PSLogger::LogType::Log, m_parser_log_cat, "Finished prelude parsing");
+	PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_parser_log_cat, "Finished prelude parsing");
 }
 
 void Parser::parse_prelude_identifier()
 {
-	string identifier_string = parse_word();
+	string_view identifier_string = parse_word();
 
 	if(str_to_enum(identifier_string, to_file_section).value_or(FileSection::None) != FileSection::None)
 	{
@@ -194,58 +208,60 @@ void Parser::parse_prelude_identifier()
 	}
 	else
 	{
-		detect_error("unidentified identifier : \"" + identifier_string + "\" in the prelude");
+		detect_error("unidentified identifier : \"" + string(identifier_string) + "\" in the prelude");
 	}
 }
 
 void Parser::parse_prelude_literal()
 {
 	string current_literal_string = "";
-	if(m_text_provider->get_current_char() != ' ')
+	if(current_char() != ' ')
 	{
-		current_literal_string.push_back(m_text_provider->get_current_char());
+		current_literal_string.push_back(current_char());
 	}
 
 	bool detected_literal_end = false;
-	while(m_text_provider->is_valid() && !detected_literal_end)
+	while(is_text_valid() && !detected_literal_end)
 	{
-		m_text_provider->advance();
+		advance();
 		if(try_parse_return(false))
 		{
 			detected_literal_end = true;
-			m_text_provider->reverse();
+			reverse();
 		}
 		else
 		{
-			switch(m_text_provider->get_current_char())
+			switch(current_char())
 			{
 				case '(':
 					parse_comment();
 					break;
 				default:
-					current_literal_string.push_back(m_text_provider->get_current_char());
+					current_literal_string.push_back(current_char());
 				break;
 			}
 		}
 	}
 
-	m_parsed_game.prelude_tokens.push_back(Token<ParsedGame::PreludeTokenType>(ParsedGame::PreludeTokenType::Literal,current_literal_string, m_line_counter));
+	//the comments are removed from the literal so it is not a slice of the text
+	m_parsed_game.source->literals.push_back(std::move(current_literal_string));
+	m_parsed_game.prelude_tokens.push_back(Token<ParsedGame::PreludeTokenType>(ParsedGame::PreludeTokenType::Literal,m_parsed_game.source->literals.back(), m_line_counter));
 }
 
 void Parser::parse_objects()
 {
-	m_logger->log(PSLogger::LogType::Log, m_parser_log_cat, "Starting objetcs parsing");
+	PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_parser_log_cat, "Starting objetcs parsing");
 
-	while(m_text_provider->is_valid() && m_current_file_section == FileSection::Objects)
+	while(is_text_valid() && m_current_file_section == FileSection::Objects)
 	{
-		m_text_provider->advance();
+		advance();
 		if(try_parse_return())
 		{
 			m_line_counter ++;
 		}
 		else
 		{
-			switch(m_text_provider->get_current_char())
+			switch(current_char())
 			{
 				case ' ':
 				case '=':
@@ -258,16 +274,14 @@ void Parser::parse_objects()
 					parse_objects_color_hex_code();
 					break;
 				default:
-					if(is_pixel(m_text_provider->get_current_char()))
+					if(is_pixel(current_char()))
 					{
-						string pixel_str = "";
-						pixel_str.push_back(m_text_provider->get_current_char());
-						Token<ParsedGame::ObjectsTokenType> pixel(ParsedGame::ObjectsTokenType::Pixel, pixel_str, m_line_counter);
+						Token<ParsedGame::ObjectsTokenType> pixel(ParsedGame::ObjectsTokenType::Pixel, m_text.substr(m_position, 1), m_line_counter);
 						m_parsed_game.objects_tokens.push_back(pixel);
 					}
 					else
 					{
-						string parsed_word = parse_word();
+						string_view parsed_word = parse_word();
 
 						if(str_to_enum(parsed_word, to_file_section).value_or(FileSection::None) != FileSection::None)
 						{
@@ -289,13 +303,13 @@ void Parser::parse_objects()
 
 	}
 
-	m_logger->log(PSLogger::LogType::Log, m_parser_log_cat, "Finished objects parsing");
+	PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_parser_log_cat, "Finished objects parsing");
 }
 
 void Parser::parse_objects_color_hex_code()
 {
 	//todo make a more robust parse function and detect incorrect hex codes
-	string color_hex_code_str = parse_word();
+	string_view color_hex_code_str = parse_word();
 	Token<ParsedGame::ObjectsTokenType> color_hex_code(ParsedGame::ObjectsTokenType::ColorHexCode, color_hex_code_str, m_line_counter);
 	m_parsed_game.objects_tokens.push_back(color_hex_code);
 }
@@ -307,11 +321,11 @@ bool Parser::is_pixel(char p_char)
 
 void Parser::parse_legend()
 {
-	m_logger->log(PSLogger::LogType::Log, m_parser_log_cat, "Starting legend parsing");
+	PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_parser_log_cat, "Starting legend parsing");
 
-	while(m_text_provider->is_valid() && m_current_file_section == FileSection::Legend)
+	while(is_text_valid() && m_current_file_section == FileSection::Legend)
 	{
-		m_text_provider->advance();
+		advance();
 		if(try_parse_return())
 		{
 			m_parsed_game.legend_tokens.push_back(Token<ParsedGame::LegendTokenType>(ParsedGame::LegendTokenType::Return,"",m_line_counter));
@@ -319,7 +333,7 @@ void Parser::parse_legend()
 		}
 		else
 		{
-			switch(m_text_provider->get_current_char())
+			switch(current_char())
 			{
 				case ' ':
 					break;
@@ -327,7 +341,7 @@ void Parser::parse_legend()
 					parse_comment();
 					break;
 				case '=':
-					if(m_text_provider->peek() == '=')
+					if(peek() == '=')
 					{
 						parse_equals_row();
 					}
@@ -337,7 +351,7 @@ void Parser::parse_legend()
 					}
 					break;
 				default:
-					string parsed_word = parse_word();
+					string_view parsed_word = parse_word();
 
 					FileSection fs = str_to_enum(parsed_word, to_file_section).value_or(FileSection::None);
 					ParsedGame::LegendTokenType ltt = str_to_enum(parsed_word, ParsedGame::to_legend_token_type).value_or(ParsedGame::LegendTokenType::None);
@@ -360,24 +374,24 @@ void Parser::parse_legend()
 
 	}
 
-	m_logger->log(PSLogger::LogType::Log, m_parser_log_cat, "Finished legend parsing");
+	PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_parser_log_cat, "Finished legend parsing");
 }
 
 void Parser::parse_sounds()
 {
 	//todo proper implementation of this section
-	m_logger->log(PSLogger::LogType::Log, m_parser_log_cat, "Starting sounds parsing : Ignoring this section for now");
+	PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_parser_log_cat, "Starting sounds parsing : Ignoring this section for now");
 
-	while(m_text_provider->is_valid() && m_current_file_section == FileSection::Sounds)
+	while(is_text_valid() && m_current_file_section == FileSection::Sounds)
 	{
-		m_text_provider->advance();
+		advance();
 		if(try_parse_return())
 		{
 			m_line_counter ++;
 		}
 		else
 		{
-			switch(m_text_provider->get_current_char())
+			switch(current_char())
 			{
 				case ' ':
 					break;
@@ -385,7 +399,7 @@ void Parser::parse_sounds()
 					parse_comment();
 					break;
 				default:
-					string parsed_word = parse_word();
+					string_view parsed_word = parse_word();
 
 					FileSection fs = str_to_enum(parsed_word, to_file_section).value_or(FileSection::None);
 
@@ -398,16 +412,16 @@ void Parser::parse_sounds()
 		}
 	}
 
-	m_logger->log(PSLogger::LogType::Log, m_parser_log_cat, "Finished sounds parsing");
+	PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_parser_log_cat, "Finished sounds parsing");
 }
 
 void Parser::parse_collision_layers()
 {
-	m_logger->log(PSLogger::LogType::Log, m_parser_log_cat, "Starting collision layers parsing");
+	PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_parser_log_cat, "Starting collision layers parsing");
 
-	while(m_text_provider->is_valid() && m_current_file_section == FileSection::CollisionLayers)
+	while(is_text_valid() && m_current_file_section == FileSection::CollisionLayers)
 	{
-		m_text_provider->advance();
+		advance();
 		if(try_parse_return())
 		{
 			m_parsed_game.collision_layers_tokens.push_back(Token<ParsedGame::CollisionLayersTokenType>(ParsedGame::CollisionLayersTokenType::Return,"",m_line_counter));
@@ -415,7 +429,7 @@ void Parser::parse_collision_layers()
 		}
 		else
 		{
-			switch(m_text_provider->get_current_char())
+			switch(current_char())
 			{
 				case '=':
 					parse_equals_row();
@@ -429,7 +443,7 @@ void Parser::parse_collision_layers()
 					m_parsed_game.collision_layers_tokens.push_back(Token<ParsedGame::CollisionLayersTokenType>(ParsedGame::CollisionLayersTokenType::Comma,"",m_line_counter));
 					break;
 				default:
-					string parsed_word = parse_word();
+					string_view parsed_word = parse_word();
 
 					FileSection fs = str_to_enum(parsed_word, to_file_section).value_or(FileSection::None);
 
@@ -448,16 +462,16 @@ void Parser::parse_collision_layers()
 
 	}
 
-	m_logger->log(PSLogger::LogType::Log, m_parser_log_cat, "Finished collision layers parsing");
+	PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_parser_log_cat, "Finished collision layers parsing");
 }
 
 void Parser::parse_rules()
 {
-	m_logger->log(PSLogger::LogType::Log, m_parser_log_cat, "Starting rules parsing");
+	PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_parser_log_cat, "Starting rules parsing");
 
-	while(m_text_provider->is_valid() && m_current_file_section == FileSection::Rules)
+	while(is_text_valid() && m_current_file_section == FileSection::Rules)
 	{
-		m_text_provider->advance();
+		advance();
 		if(try_parse_return())
 		{
 			m_parsed_game.rules_tokens.push_back(Token<ParsedGame::RulesTokenType>(ParsedGame::RulesTokenType::Return,"",m_line_counter));
@@ -465,7 +479,7 @@ void Parser::parse_rules()
 		}
 		else
 		{
-			switch(m_text_provider->get_current_char())
+			switch(current_char())
 			{
 				case '=':
 					parse_equals_row();
@@ -488,9 +502,9 @@ void Parser::parse_rules()
 					m_parsed_game.rules_tokens.push_back(Token<ParsedGame::RulesTokenType>(ParsedGame::RulesTokenType::Bar,"",m_line_counter));
 					break;
 				case '-':
-					if(m_text_provider->peek() == '>')
+					if(peek() == '>')
 					{
-						m_text_provider->advance();
+						advance();
 						m_parsed_game.rules_tokens.push_back(Token<ParsedGame::RulesTokenType>(ParsedGame::RulesTokenType::Arrow,"",m_line_counter));
 					}
 					else
@@ -502,18 +516,18 @@ void Parser::parse_rules()
 				case '>':
 				case '^':
 				case '<':
-					if(m_text_provider->peek() == ' ')
+					if(peek() == ' ')
 					{
 						ParsedGame::RulesTokenType token_type = ParsedGame::RulesTokenType::RelativeRight;
-						if(m_text_provider->get_current_char() == '<')
+						if(current_char() == '<')
 						{
 							token_type = ParsedGame::RulesTokenType::RelativeLeft;
 						}
-						else if(m_text_provider->get_current_char() == '^')
+						else if(current_char() == '^')
 						{
 							token_type = ParsedGame::RulesTokenType::RelativeUp;
 						}
-						else if(m_text_provider->get_current_char() == 'v')
+						else if(current_char() == 'v')
 						{
 							token_type = ParsedGame::RulesTokenType::RelativeDown;
 						}
@@ -529,10 +543,10 @@ void Parser::parse_rules()
 					}
 					break;
 				case '.':
-					if(m_text_provider->peek() == '.' && m_text_provider->peek_next() == '.')
+					if(peek() == '.' && peek_next() == '.')
 					{
-						m_text_provider->advance();
-						m_text_provider->advance();
+						advance();
+						advance();
 						m_parsed_game.rules_tokens.push_back(Token<ParsedGame::RulesTokenType>(ParsedGame::RulesTokenType::Dots,"",m_line_counter));
 					}
 					break;
@@ -550,12 +564,12 @@ void Parser::parse_rules()
 		}
 	}
 
-	m_logger->log(PSLogger::LogType::Log, m_parser_log_cat, "Finished rules parsing");
+	PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_parser_log_cat, "Finished rules parsing");
 }
 
 void Parser::parse_rules_word()
 {
-	string parsed_word = parse_word();
+	string_view parsed_word = parse_word();
 
 	FileSection fs = str_to_enum(parsed_word, to_file_section).value_or(FileSection::None);
 
@@ -567,7 +581,7 @@ void Parser::parse_rules_word()
 	{
 		ci_equal comp_equal;
 
-		vector<string> reserved_words = {
+		static const vector<string> reserved_words = {
 			"NO",
 			"LATE",
 			"AGAIN",
@@ -599,7 +613,7 @@ void Parser::parse_rules_word()
 			if(token_type == ParsedGame::RulesTokenType::None)
 			{
 				//todo more explicit error message
-				detect_error(parsed_word);
+				detect_error(string(parsed_word));
 			}
 
 			m_parsed_game.rules_tokens.push_back(Token<ParsedGame::RulesTokenType>(token_type,"",m_line_counter));
@@ -613,11 +627,11 @@ void Parser::parse_rules_word()
 
 void Parser::parse_win_conditions()
 {
-	m_logger->log(PSLogger::LogType::Log, m_parser_log_cat, "Starting win conditions parsing");
+	PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_parser_log_cat, "Starting win conditions parsing");
 
-	while(m_text_provider->is_valid() && m_current_file_section == FileSection::WinConditions)
+	while(is_text_valid() && m_current_file_section == FileSection::WinConditions)
 	{
-		m_text_provider->advance();
+		advance();
 		if(try_parse_return())
 		{
 			m_parsed_game.win_conditions_tokens.push_back(Token<ParsedGame::WinConditionsTokenType>(ParsedGame::WinConditionsTokenType::Return,"",m_line_counter));
@@ -625,7 +639,7 @@ void Parser::parse_win_conditions()
 		}
 		else
 		{
-			switch(m_text_provider->get_current_char())
+			switch(current_char())
 			{
 				case '=':
 					parse_equals_row();
@@ -642,7 +656,7 @@ void Parser::parse_win_conditions()
 					detect_error("Unexpected symbol.");
 					break;
 				default:
-					string parsed_word = parse_word();
+					string_view parsed_word = parse_word();
 
 					FileSection fs = str_to_enum(parsed_word, to_file_section).value_or(FileSection::None);
 
@@ -654,7 +668,7 @@ void Parser::parse_win_conditions()
 					{
 						ci_equal comp_equal;
 
-						vector<string> reserved_words = {"NO", "ON", "ALL", "SOME"};
+						static const vector<string> reserved_words = {"NO", "ON", "ALL", "SOME"};
 
 						auto found_reserved_word = std::find_if(reserved_words.begin(),reserved_words.end(),[&](const string& s){
 							return comp_equal(s, parsed_word);
@@ -666,7 +680,7 @@ void Parser::parse_win_conditions()
 							if(token_type == ParsedGame::WinConditionsTokenType::None)
 							{
 								//todo more explicit error message
-								detect_error(parsed_word);
+								detect_error(string(parsed_word));
 							}
 
 							m_parsed_game.win_conditions_tokens.push_back(Token<ParsedGame::WinConditionsTokenType>(token_type,"",m_line_counter));
@@ -681,16 +695,16 @@ void Parser::parse_win_conditions()
 		}
 	}
 
-	m_logger->log(PSLogger::LogType::Log, m_parser_log_cat, "Finished win conditions parsing");
+	PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_parser_log_cat, "Finished win conditions parsing");
 }
 
 void Parser::parse_levels()
 {
-	m_logger->log(PSLogger::LogType::Log, m_parser_log_cat, "Starting levels parsing");
+	PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_parser_log_cat, "Starting levels parsing");
 	bool is_line_beggining = false;
-	while(m_text_provider->is_valid() && m_current_file_section == FileSection::Levels)
+	while(is_text_valid() && m_current_file_section == FileSection::Levels)
 	{
-		m_text_provider->advance();
+		advance();
 		if(try_parse_return())
 		{
 			is_line_beggining = true;
@@ -699,7 +713,7 @@ void Parser::parse_levels()
 		}
 		else
 		{
-			switch(m_text_provider->get_current_char())
+			switch(current_char())
 			{
 				case '=':
 					parse_equals_row();
@@ -712,12 +726,10 @@ void Parser::parse_levels()
 					parse_comment();
 					break;
 				default:
-					if((m_text_provider->get_current_char() != 'm' && m_text_provider->get_current_char() != 'M')
+					if((current_char() != 'm' && current_char() != 'M')
 					|| (!is_line_beggining || !try_parse_message(m_parsed_game.levels_tokens)))
 					{
-						string tile = "";
-						tile.push_back(m_text_provider->get_current_char());
-						m_parsed_game.levels_tokens.push_back(Token<ParsedGame::LevelsTokenType>(ParsedGame::LevelsTokenType::LevelTile,tile,m_line_counter));
+						m_parsed_game.levels_tokens.push_back(Token<ParsedGame::LevelsTokenType>(ParsedGame::LevelsTokenType::LevelTile,m_text.substr(m_position, 1),m_line_counter));
 					}
 					is_line_beggining = false;
 				break;
@@ -725,55 +737,50 @@ void Parser::parse_levels()
 		}
 	}
 
-	m_logger->log(PSLogger::LogType::Log, m_parser_log_cat, "Finished levels parsing");
+	PS_LOGGER_LOG(m_logger, PSLogger::LogType::Log, m_parser_log_cat, "Finished levels parsing");
 }
 
 void Parser::parse_equals_row()
 {
-	while(m_text_provider->is_valid() && m_text_provider->peek() == '=')
+	while(is_text_valid() && peek() == '=')
 	{
-		m_text_provider->advance();
+		advance();
 	}
 }
 
 //todo : since some tokens are excluded here but not handled in every section parser, this may lead to infinite loop if the file is not correct
-string Parser::parse_word()
+string_view Parser::parse_word()
 {
-	string current_string = "";
-	current_string.push_back(m_text_provider->get_current_char());
-
-	bool detected_word_end = false;
-	while(m_text_provider->is_valid() && !detected_word_end)
+	size_t word_start = (size_t)m_position;
+	size_t word_end = word_start + 1;
+	while(word_end < m_text.size() && !is_word_delimiter(m_text[word_end]))
 	{
-		m_text_provider->advance();
-		if(try_parse_return(false))
-		{
-			detected_word_end = true;
-			m_text_provider->reverse();
-		}
-		else
-		{
-			switch(m_text_provider->get_current_char())
-			{
-				case '=':
-				case ',':
-				case '(':
-				case '[':
-				case ']':
-				case '|':
-				case ' ':
-					detected_word_end = true;
-					m_text_provider->reverse();
-				break;
-
-				default:
-					current_string.push_back(m_text_provider->get_current_char());
-				break;
-			}
-		}
+		++word_end;
 	}
 
-	return current_string;
+	//a word that goes until the end of the text consumes it
+	set_position(word_end < m_text.size() ? (int64_t)word_end - 1 : (int64_t)m_text.size());
+
+	return word_start < m_text.size() ? m_text.substr(word_start, word_end - word_start) : string_view();
+}
+
+bool Parser::is_word_delimiter(char p_char)
+{
+	switch(p_char)
+	{
+		case '=':
+		case ',':
+		case '(':
+		case '[':
+		case ']':
+		case '|':
+		case ' ':
+		case '\n':
+		case '\r':
+			return true;
+		default:
+			return false;
+	}
 }
 
 void Parser::parse_comment(int p_comment_level /*= 0*/)
@@ -782,16 +789,16 @@ void Parser::parse_comment(int p_comment_level /*= 0*/)
 
 	bool continue_parsing = true;
 
-	while(m_text_provider->is_valid() && continue_parsing)
+	while(is_text_valid() && continue_parsing)
 	{
-		m_text_provider->advance();
+		advance();
 		if(try_parse_return())
 		{
 			++ m_line_counter;
 		}
 		else
 		{
-			switch (m_text_provider->get_current_char())
+			switch (current_char())
 			{
 			case '(':
 				parse_comment(p_comment_level + 1);
@@ -806,7 +813,7 @@ void Parser::parse_comment(int p_comment_level /*= 0*/)
 		}
 	}
 
-	if(!m_text_provider->is_valid())
+	if(!is_text_valid())
 	{
 		detect_error("Unexpected end of file : ");
 	}
@@ -816,17 +823,17 @@ void Parser::parse_comment(int p_comment_level /*= 0*/)
 
 bool Parser::try_parse_return(bool consume /* = true*/)
 {
-	if(m_text_provider->get_current_char() == '\n')
+	if(current_char() == '\n')
 	{
 		return true;
 	}
-	else if(m_text_provider->get_current_char() == '\r')
+	else if(current_char() == '\r')
 	{
-		if(m_text_provider->advance() == '\n')
+		if(advance() == '\n')
 		{
 			if(consume == false)
 			{
-				m_text_provider->reverse();
+				reverse();
 			}
 			return true;
 		}
@@ -1,11 +1,23 @@
 
+#include <iterator>
+
 #include "TextProvider.hpp"
 #include "PSLogger.hpp"
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 const string TextProvider::m_parser_text_provider_log_cat = "parser_text_provider";
 
 TextProviderString::TextProviderString(shared_ptr<PSLogger> p_logger, string p_text)
-:TextProvider(p_logger), m_text(p_text)
+:TextProvider(p_logger), m_text(std::move(p_text))
 {
 	//todo add some kind of check in case the logger isn't valid
 
@@ -212,3 +224,146 @@ char TextProviderFile::peek_next()
 		return '\0';
 	}
 }
+
+string_view TextProviderFile::get_text()
+{
+	if(m_text.empty() && m_file.is_open())
+	{
+		m_file.clear();
+		m_file.seekg(0);
+		m_text.assign(istreambuf_iterator<char>(m_file), istreambuf_iterator<char>());
+	}
+	return m_text;
+}
+
+TextProviderMappedFile::TextProviderMappedFile(shared_ptr<PSLogger> p_logger, string p_file_path)
+:TextProvider(p_logger), m_file_path(p_file_path)
+{
+	//the file handles are closed as soon as the file is mapped, the mapping stays valid until it is unmapped
+#ifdef _WIN32
+	HANDLE file = CreateFileA(m_file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file != INVALID_HANDLE_VALUE)
+	{
+		LARGE_INTEGER file_size;
+		if(GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+		{
+			m_size = (size_t)file_size.QuadPart;
+			HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if(mapping != nullptr)
+			{
+				m_data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				CloseHandle(mapping);
+			}
+		}
+		CloseHandle(file);
+	}
+	else
+	{
+		m_logger->log(PSLogger::LogType::Error, m_parser_text_provider_log_cat, "couldn't open file : "+ m_file_path + ". Parsing will fail.");
+		m_has_error = true;
+		return;
+	}
+#else
+	int file = open(m_file_path.c_str(), O_RDONLY);
+	if(file != -1)
+	{
+		struct stat file_stat;
+		if(fstat(file, &file_stat) == 0 && file_stat.st_size > 0)
+		{
+			m_size = (size_t)file_stat.st_size;
+			void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+			if(data != MAP_FAILED)
+			{
+				//the file is read once from start to end
+				madvise(data, m_size, MADV_SEQUENTIAL);
+				m_data = (const char*)data;
+			}
+		}
+		close(file);
+	}
+	else
+	{
+		m_logger->log(PSLogger::LogType::Error, m_parser_text_provider_log_cat, "couldn't open file : "+ m_file_path + ". Parsing will fail.");
+		m_has_error = true;
+		return;
+	}
+#endif
+
+	if(m_data == nullptr)
+	{
+		m_logger->log(PSLogger::LogType::Error, m_parser_text_provider_log_cat, "couldn't map file : "+ m_file_path + ", it may be empty. Parsing will fail.");
+		m_size = 0;
+		m_has_error = true;
+	}
+	else
+	{
+		m_current_char_idx = 0;
+	}
+}
+
+TextProviderMappedFile::~TextProviderMappedFile()
+{
+	if(m_data != nullptr)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_data);
+#else
+		munmap((void*)m_data, m_size);
+#endif
+	}
+}
+
+bool TextProviderMappedFile::is_valid()
+{
+	return TextProvider::is_valid() && m_position < (int64_t)m_size;
+}
+
+char TextProviderMappedFile::advance()
+{
+	if(is_valid())
+	{
+		++m_current_char_idx;
+		++m_position;
+		m_current_char = m_position < (int64_t)m_size ? m_data[m_position] : '\0';
+
+		if( static_cast<unsigned char>(m_current_char) > 127)
+		{
+			m_logger->log(PSLogger::LogType::Error, m_parser_text_provider_log_cat,
+			"detected non ascii character ( n : "+to_string(m_current_char_idx)+". this interpreter does not yet support unicode files, sorry :/");
+			m_has_error = true;
+		}
+	}
+	else
+	{
+		m_current_char = '\0';
+	}
+	return m_current_char;
+}
+
+void TextProviderMappedFile::reverse()
+{
+	if(is_valid() && m_position > 0)
+	{
+		--m_current_char_idx;
+		--m_position;
+		m_current_char = m_data[m_position];
+	}
+}
+
+char TextProviderMappedFile::peek()
+{
+	if(is_valid() && m_position + 1 < (int64_t)m_size)
+	{
+		return m_data[m_position + 1];
+	}
+	return '\0';
+}
+
+char TextProviderMappedFile::peek_next()
+{
+	if(is_valid() && m_position + 2 < (int64_t)m_size)
+	{
+		return m_data[m_position + 2];
+	}
+	return '\0';
+}
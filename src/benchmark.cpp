@@ -0,0 +1,361 @@
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <optional>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#include "TextProvider.hpp"
+#include "Parser.hpp"
+#include "Compiler.hpp"
+#include "CompiledGameSerializer.hpp"
+#include "PSEngine.hpp"
+#include "EnumHelpers.hpp"
+
+//standalone benchmark measuring, for every game of the resources folder, the time and allocations spent in each phase
+//from reading the text to receiving inputs. Results are written as csv so that two builds can be diffed.
+//the progress and errors go to cerr, so that the results written to cout can be redirected to a file.
+
+//written in the first column of every row so that the output stays plain csv
+const int BENCHMARK_RESULTS_VERSION = 2;
+
+//allocation counters, the benchmark is single threaded so they don't need to be atomic
+static uint64_t s_allocation_count = 0;
+static uint64_t s_allocated_bytes = 0;
+
+void* operator new(size_t p_size)
+{
+    ++s_allocation_count;
+    s_allocated_bytes += p_size;
+    if(void* ptr = malloc(p_size == 0 ? 1 : p_size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t p_size)
+{
+    return operator new(p_size);
+}
+
+void operator delete(void* p_ptr) noexcept
+{
+    free(p_ptr);
+}
+
+void operator delete[](void* p_ptr) noexcept
+{
+    free(p_ptr);
+}
+
+void operator delete(void* p_ptr, size_t) noexcept
+{
+    free(p_ptr);
+}
+
+void operator delete[](void* p_ptr, size_t) noexcept
+{
+    free(p_ptr);
+}
+
+struct PhaseSample
+{
+    uint64_t duration_ns = 0;
+    uint64_t allocation_count = 0;
+    uint64_t allocated_bytes = 0;
+};
+
+struct PhaseResults
+{
+    string game;
+    string phase;
+    vector<PhaseSample> samples;
+};
+
+class PhaseTimer
+{
+public:
+    PhaseTimer(PhaseResults& p_results):m_results(p_results)
+    {
+        m_start_allocation_count = s_allocation_count;
+        m_start_allocated_bytes = s_allocated_bytes;
+        m_start_time = std::chrono::high_resolution_clock::now();
+    }
+
+    ~PhaseTimer()
+    {
+        auto end_time = std::chrono::high_resolution_clock::now();
+
+        PhaseSample sample;
+        sample.duration_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - m_start_time).count();
+        sample.allocation_count = s_allocation_count - m_start_allocation_count;
+        sample.allocated_bytes = s_allocated_bytes - m_start_allocated_bytes;
+        m_results.samples.push_back(sample);
+    }
+
+private:
+    PhaseResults& m_results;
+    std::chrono::high_resolution_clock::time_point m_start_time;
+    uint64_t m_start_allocation_count = 0;
+    uint64_t m_start_allocated_bytes = 0;
+};
+
+struct BenchmarkConfig
+{
+    string resources_folder_path = "resources/";
+    string output_path = "";
+    int run_number = 10;
+    int inputs_per_level = 50;
+};
+
+//nearest rank percentile, p_sorted_values must not be empty
+uint64_t get_percentile(const vector<uint64_t>& p_sorted_values, int p_percentile)
+{
+    size_t rank = (p_sorted_values.size() * p_percentile + 99) / 100;
+    return p_sorted_values[rank == 0 ? 0 : rank - 1];
+}
+
+//same deterministic sequence for every build so that timings can be compared
+PSEngine::InputType get_next_input(uint32_t& p_seed)
+{
+    static const PSEngine::InputType inputs[] = {
+        PSEngine::InputType::Up,
+        PSEngine::InputType::Down,
+        PSEngine::InputType::Left,
+        PSEngine::InputType::Right,
+        PSEngine::InputType::Action,
+    };
+
+    p_seed = p_seed * 1664525u + 1013904223u;
+    return inputs[(p_seed >> 16) % 5];
+}
+
+void benchmark_game(const BenchmarkConfig& p_config, const string& p_file_name, vector<PhaseResults>& p_out_results)
+{
+    string file_path = p_config.resources_folder_path + p_file_name;
+
+    shared_ptr<PSLogger> logger = make_shared<PSLogger>(PSLogger());
+    logger->log_verbosity = PSLogger::LogType::Critical;
+
+    PhaseResults text_provider_results{p_file_name, "text_provider", {}};
+    PhaseResults parse_results{p_file_name, "parse", {}};
+    PhaseResults compile_results{p_file_name, "compile", {}};
+    PhaseResults load_serialized_results{p_file_name, "load_serialized", {}};
+    PhaseResults load_level_results{p_file_name, "load_level", {}};
+    PhaseResults receive_input_results{p_file_name, "receive_input", {}};
+
+    for(int run = 0; run < p_config.run_number; ++run)
+    {
+        {
+            PhaseTimer timer(text_provider_results);
+            TextProviderMappedFile text_provider(logger, file_path);
+            while(text_provider.is_valid())
+            {
+                text_provider.advance();
+            }
+        }
+
+        optional<ParsedGame> parsed_game;
+        {
+            PhaseTimer timer(parse_results);
+            parsed_game = Parser::parse_from_file(file_path, logger);
+        }
+        if(!parsed_game.has_value())
+        {
+            cerr << "skipping " << p_file_name << " : it could not be parsed.\n";
+            return;
+        }
+
+        optional<CompiledGame> compiled_game;
+        {
+            PhaseTimer timer(compile_results);
+            Compiler puzzle_compiler(logger);
+            compiled_game = puzzle_compiler.compile_game(parsed_game.value());
+        }
+        if(!compiled_game.has_value())
+        {
+            cerr << "skipping " << p_file_name << " : it could not be compiled.\n";
+            return;
+        }
+
+        vector<uint8_t> serialized_game;
+        CompiledGameSerializer::serialize(compiled_game.value(), 0, serialized_game, logger);
+        {
+            PhaseTimer timer(load_serialized_results);
+            compiled_game = CompiledGameSerializer::deserialize(serialized_game.data(), serialized_game.size(), 0, logger);
+        }
+        if(!compiled_game.has_value())
+        {
+            cerr << "skipping " << p_file_name << " : it could not be serialized.\n";
+            return;
+        }
+
+        PSEngine::Config engine_config;
+        engine_config.log_verbosity = PSLogger::LogType::Critical;
+        engine_config.log_operation_history_after_error = false;
+        PSEngine engine(engine_config, logger);
+        engine.load_game(compiled_game.value());
+
+        uint32_t input_seed = 0;
+        for(int level_idx = 0; level_idx < engine.get_number_of_levels(); ++level_idx)
+        {
+            {
+                PhaseTimer timer(load_level_results);
+                engine.load_level(level_idx);
+            }
+
+            for(int input_idx = 0; input_idx < p_config.inputs_per_level; ++input_idx)
+            {
+                PSEngine::InputType input = get_next_input(input_seed);
+                {
+                    PhaseTimer timer(receive_input_results);
+                    engine.receive_input(input);
+                }
+                if(engine.is_level_won())
+                {
+                    engine.restart_level();
+                }
+            }
+        }
+    }
+
+    p_out_results.push_back(std::move(text_provider_results));
+    p_out_results.push_back(std::move(parse_results));
+    p_out_results.push_back(std::move(compile_results));
+    p_out_results.push_back(std::move(load_serialized_results));
+    p_out_results.push_back(std::move(load_level_results));
+    p_out_results.push_back(std::move(receive_input_results));
+}
+
+void write_results(const vector<PhaseResults>& p_results, ostream& p_out)
+{
+    p_out << "format_version,game,phase,samples,min_ns,p50_ns,p90_ns,p99_ns,max_ns,mean_ns,mean_allocations,mean_allocated_bytes\n";
+
+    for(const PhaseResults& results : p_results)
+    {
+        if(results.samples.empty())
+        {
+            continue;
+        }
+
+        vector<uint64_t> durations;
+        uint64_t total_duration = 0;
+        uint64_t total_allocation_count = 0;
+        uint64_t total_allocated_bytes = 0;
+        for(const PhaseSample& sample : results.samples)
+        {
+            durations.push_back(sample.duration_ns);
+            total_duration += sample.duration_ns;
+            total_allocation_count += sample.allocation_count;
+            total_allocated_bytes += sample.allocated_bytes;
+        }
+        std::sort(durations.begin(), durations.end());
+
+        const uint64_t sample_count = results.samples.size();
+        p_out << BENCHMARK_RESULTS_VERSION << "," << results.game << "," << results.phase << "," << sample_count
+            << "," << durations.front()
+            << "," << get_percentile(durations, 50)
+            << "," << get_percentile(durations, 90)
+            << "," << get_percentile(durations, 99)
+            << "," << durations.back()
+            << "," << total_duration / sample_count
+            << "," << total_allocation_count / sample_count
+            << "," << total_allocated_bytes / sample_count << "\n";
+    }
+}
+
+void print_usage()
+{
+    cout << "usage : psionic_benchmark [-runs <count>] [-inputs <count per level>] [-output <csv file>] [resources folder]\n";
+}
+
+int main(int argc, char *argv[])
+{
+    BenchmarkConfig config;
+
+    ci_equal equal_op;
+
+    for(int arg_idx = 1; arg_idx < argc; ++arg_idx)
+    {
+        string arg = argv[arg_idx];
+        bool has_value = arg_idx + 1 < argc;
+
+        try
+        {
+            if(equal_op(arg, "-runs") && has_value)
+            {
+                config.run_number = std::max(1, stoi(argv[++arg_idx]));
+            }
+            else if(equal_op(arg, "-inputs") && has_value)
+            {
+                config.inputs_per_level = std::max(0, stoi(argv[++arg_idx]));
+            }
+            else if(equal_op(arg, "-output") && has_value)
+            {
+                config.output_path = argv[++arg_idx];
+            }
+            else if(arg.size() > 0 && arg[0] != '-')
+            {
+                config.resources_folder_path = arg;
+                if(config.resources_folder_path.back() != '/')
+                {
+                    config.resources_folder_path += '/';
+                }
+            }
+            else
+            {
+                cerr << "error : incorrect argument " << arg << "\n";
+                print_usage();
+                return EXIT_FAILURE;
+            }
+        }
+        catch(...)
+        {
+            cerr << "error : incorrect value for argument " << arg << "\n";
+            print_usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    //sorting the games so that the results are always written in the same order
+    vector<string> file_names;
+    for (const auto & entry : std::filesystem::directory_iterator(config.resources_folder_path))
+    {
+        if(entry.is_regular_file() && !equal_op(entry.path().extension().string(), ".test_record"))
+        {
+            file_names.push_back(entry.path().filename().string());
+        }
+    }
+    std::sort(file_names.begin(), file_names.end());
+
+    vector<PhaseResults> results;
+    for(const string& file_name : file_names)
+    {
+        cerr << "benchmarking " << file_name << "\n";
+        benchmark_game(config, file_name, results);
+    }
+
+    if(config.output_path.empty())
+    {
+        write_results(results, cout);
+    }
+    else
+    {
+        ofstream output_file(config.output_path, ios::out | ios::trunc);
+        if(!output_file.is_open())
+        {
+            cerr << "error : could not open " << config.output_path << "\n";
+            return EXIT_FAILURE;
+        }
+        write_results(results, output_file);
+        cout << "results written to " << config.output_path << "\n";
+    }
+
+    return 0;
+}
@@ -8,18 +8,31 @@
 #include "Parser.hpp"
 #include "Compiler.hpp"
 #include "PSEngine.hpp"
+#include "PSSolver.hpp"
+#include "CompiledGameSerializer.hpp"
+#include "PSCatalogLoader.hpp"
 #include "EnumHelpers.hpp"
 
-const int TEST_RECORD_VERSION = 1;
+const int TEST_RECORD_VERSION = PSSolver::TEST_RECORD_VERSION;
 
-optional<CompiledGame> compile_game(string file_path, bool use_string_text_provider)
+//the compiled games are cached out of the resources folder, which the tests and the benchmark scan for games
+const string COMPILED_CACHE_FOLDER_PATH = "compiled_cache/";
+
+enum class GameSource
+{
+    FileTextProvider,
+    StringTextProvider,
+    SerializedGame, //compiled from the file, then serialized and read back
+};
+
+optional<CompiledGame> compile_game(string file_path, GameSource game_source)
 {
     shared_ptr<PSLogger> logger = make_shared<PSLogger>(PSLogger());
     logger->log_verbosity = PSLogger::LogType::Warning;
 
     ParsedGame parsed_game;
 
-    if(use_string_text_provider)
+    if(game_source == GameSource::StringTextProvider)
     {
         std::ifstream ifs(file_path);
         std::string content( (std::istreambuf_iterator<char>(ifs) ),
@@ -36,7 +49,52 @@ optional<CompiledGame> compile_game(string file_path, bool use_string_text_provi
     //parsed_game.print_parsed_game(false,false,false,false,true,false,false);
 
     Compiler puzzle_compiler(logger);
-    return puzzle_compiler.compile_game(parsed_game);
+    optional<CompiledGame> compiled_game = puzzle_compiler.compile_game(parsed_game);
+
+    if(game_source == GameSource::SerializedGame && compiled_game.has_value())
+    {
+        vector<uint8_t> buffer;
+        if(!CompiledGameSerializer::serialize(compiled_game.value(), 0, buffer, logger))
+        {
+            return nullopt;
+        }
+        return CompiledGameSerializer::deserialize(buffer.data(), buffer.size(), 0, logger);
+    }
+
+    return compiled_game;
+}
+
+//loads the game from its cache file, the game is compiled and the cache written when it is missing or out of date
+//games with the same file name share a cache file, the source hash makes sure that the one of another game is never loaded
+optional<CompiledGame> load_or_compile_game(string file_path)
+{
+    shared_ptr<PSLogger> logger = make_shared<PSLogger>(PSLogger());
+    logger->log_verbosity = PSLogger::LogType::Warning;
+
+    std::ifstream ifs(file_path, ios::binary);
+    std::string content( (std::istreambuf_iterator<char>(ifs) ),
+                    (std::istreambuf_iterator<char>()    ) );
+
+    uint64_t source_hash = CompiledGameSerializer::hash_source(content);
+    string cache_file_path = COMPILED_CACHE_FOLDER_PATH + std::filesystem::path(file_path).filename().string() + ".compiled";
+
+    optional<CompiledGame> compiled_game = CompiledGameSerializer::load_from_file(cache_file_path, source_hash, logger);
+    if(compiled_game.has_value())
+    {
+        return compiled_game;
+    }
+
+    ParsedGame parsed_game = Parser::parse_from_string(std::move(content),logger).value_or(ParsedGame());
+
+    Compiler puzzle_compiler(logger);
+    compiled_game = puzzle_compiler.compile_game(parsed_game);
+    std::error_code error;
+    if(compiled_game.has_value() && (std::filesystem::create_directories(COMPILED_CACHE_FOLDER_PATH, error) || !error))
+    {
+        CompiledGameSerializer::save_to_file(compiled_game.value(), source_hash, cache_file_path, logger);
+    }
+
+    return compiled_game;
 }
 
 void parse_and_send_game_input(PSEngine& p_engine, char input)
@@ -97,7 +155,7 @@ void parse_and_send_game_input(PSEngine& p_engine, char input)
 
 void load_and_run_game(string file_path)
 {
-    std::optional<CompiledGame> compiled_game_opt = compile_game(file_path,false);
+    std::optional<CompiledGame> compiled_game_opt = load_or_compile_game(file_path);
     if(!compiled_game_opt.has_value())
     {
         return;
@@ -154,7 +212,7 @@ void run_game_and_record_test_file(string resources_folder_path, string file_nam
 {
     string file_path = resources_folder_path + file_name;
 
-    std::optional<CompiledGame> compiled_game_opt = compile_game(file_path,false);
+    std::optional<CompiledGame> compiled_game_opt = compile_game(file_path,GameSource::FileTextProvider);
     if(!compiled_game_opt.has_value())
     {
         cout << "error: cannot record a test file for a file that does not compile.\n";
@@ -252,7 +310,43 @@ void run_game_and_record_test_file(string resources_folder_path, string file_nam
     record_file.close();
 }
 
-bool run_tests(string directory_path, bool use_string_text_provider, std::chrono::microseconds* duration)
+void solve_game_and_record_test_file(string resources_folder_path, string file_name)
+{
+    string file_path = resources_folder_path + file_name;
+
+    std::optional<CompiledGame> compiled_game_opt = compile_game(file_path,GameSource::FileTextProvider);
+    if(!compiled_game_opt.has_value())
+    {
+        cout << "error: cannot solve a file that does not compile.\n";
+        return;
+    }
+
+    shared_ptr<PSLogger> logger = make_shared<PSLogger>(PSLogger());
+    logger->log_verbosity = PSLogger::LogType::Log;
+
+    PSSolver solver(make_shared<const CompiledGame>(std::move(compiled_game_opt.value())), PSSolver::Config(), logger);
+
+    cout << "solving every level of " << file_path << "\n";
+    vector<PSSolver::Result> results = solver.solve_all_levels();
+
+    for(const PSSolver::Result& result : results)
+    {
+        string solution;
+        for(PSEngine::InputType input : result.solution)
+        {
+            solution += PSSolver::input_to_record_char(input);
+        }
+        cout << "level " << result.level_idx << " : " << enum_to_str(result.status, PSSolver::to_status).value_or("ERROR") << " " << solution
+            << " (" << result.visited_states << " states, " << result.duration_ns/1000000 << " ms)\n";
+    }
+
+    if(!PSSolver::write_test_record(file_path + ".test_record", file_name, results))
+    {
+        cout << "error: could not create a record file in the directory\n";
+    }
+}
+
+bool run_tests(string directory_path, GameSource game_source, std::chrono::microseconds* duration)
 {
     auto start_time = std::chrono::high_resolution_clock::now();
 
@@ -263,9 +357,21 @@ bool run_tests(string directory_path, bool use_string_text_provider, std::chrono
 
     bool has_error = false;
 
-    cout << "Running the tests with the "<< (use_string_text_provider ? "string" :"file") <<" text provider\n";
+    switch(game_source)
+    {
+    case GameSource::FileTextProvider:
+        cout << "Running the tests with the file text provider\n";
+        break;
+    case GameSource::StringTextProvider:
+        cout << "Running the tests with the string text provider\n";
+        break;
+    case GameSource::SerializedGame:
+        cout << "Running the tests with the serialized compiled games\n";
+        break;
+    }
 
-    for (const auto & entry : std::filesystem::directory_iterator(directory_path))
+    //the records of the subfolders are also run, the games that are too slow to be benchmarked are put there
+    for (const auto & entry : std::filesystem::recursive_directory_iterator(directory_path))
     {
         if(equal_op(entry.path().extension().string(),".test_record"))
         {
@@ -293,7 +399,7 @@ bool run_tests(string directory_path, bool use_string_text_provider, std::chrono
 
             getline(test_record_f,record_line);
 
-            std::optional<CompiledGame> compiled_game_opt = compile_game(directory_path + record_line,use_string_text_provider);
+            std::optional<CompiledGame> compiled_game_opt = compile_game((entry.path().parent_path() / record_line).string(),game_source);
             if(!compiled_game_opt.has_value())
             {
                 cout << "error: cannot compile associated game, test wont be possible on this game.\n";
@@ -302,6 +408,14 @@ bool run_tests(string directory_path, bool use_string_text_provider, std::chrono
             }
             CompiledGame compiled_game = compiled_game_opt.value();
 
+            //there is a messages slot before every level and one after the last level
+            if(compiled_game.levels_messages.size() != compiled_game.levels.size() + 1)
+            {
+                cout << "error : the game has " << compiled_game.levels.size() << " levels but " << compiled_game.levels_messages.size() << " levels messages slots.\n";
+                has_error = true;
+                continue;
+            }
+
             PSEngine::Config engine_config;
             engine_config.log_verbosity = PSLogger::LogType::Error;
             PSEngine engine(engine_config, logger);
@@ -356,6 +470,14 @@ bool run_tests(string directory_path, bool use_string_text_provider, std::chrono
 
                         parse_and_send_game_input(engine,record_line[0]);
 
+                        //the solver and the again loop detection compare levels by their hash, the same content must always give the same hash
+                        if(engine.get_level_hash() != engine.compute_rebuilt_level_hash())
+                        {
+                            cout << "error : the level hash differs from the hash of the same level rebuilt from its content.\n";
+                            has_error = true;
+                            break;
+                        }
+
                         if(engine.is_level_won())
                         {
                             getline(test_record_f,record_line);
@@ -388,6 +510,36 @@ bool run_tests(string directory_path, bool use_string_text_provider, std::chrono
     return !has_error;
 }
 
+void load_catalog(string directory_path)
+{
+    vector<string> file_paths = PSCatalogLoader::find_game_files(directory_path);
+
+    cout << "loading the " << file_paths.size() << " games of " << directory_path << "\n";
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    map<string, PSCatalogLoader::LoadedGame> loaded_games = PSCatalogLoader::load_games(file_paths);
+    auto end_time = std::chrono::high_resolution_clock::now();
+
+    int compiled_game_count = 0;
+    for(const auto& loaded_game : loaded_games)
+    {
+        if(loaded_game.second.compiled_game != nullptr)
+        {
+            ++compiled_game_count;
+        }
+
+        cout << loaded_game.first << " : " << (loaded_game.second.compiled_game != nullptr ? "compiled" : "failed")
+            << " in " << loaded_game.second.duration_ns/1000 << " microseconds, " << loaded_game.second.diagnostics.size() << " diagnostics\n";
+        for(const PSCatalogLoader::Diagnostic& diagnostic : loaded_game.second.diagnostics)
+        {
+            cout << "    " << diagnostic.category << " : " << diagnostic.message << "\n";
+        }
+    }
+
+    cout << compiled_game_count << "/" << loaded_games.size() << " games compiled in "
+        << std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() << " microseconds.\n";
+}
+
 int main(int argc, char *argv[])
 {
     string resources_folder_path = "resources/";
@@ -397,7 +549,9 @@ int main(int argc, char *argv[])
 
     bool test_requested = false;
     bool record_requested = false;
+    bool solve_requested = false;
     bool perf_test_requested = false;
+    bool catalog_requested = false;
 
     ci_equal equal_op;
 
@@ -411,6 +565,10 @@ int main(int argc, char *argv[])
         {
             perf_test_requested = true;
         }
+        else if(equal_op(argv[1],"catalog"))
+        {
+            catalog_requested = true;
+        }
         else
         {
             file_name = argv[1];
@@ -419,15 +577,19 @@ int main(int argc, char *argv[])
 
     if(argc >= 3)
     {
-        if(test_requested || perf_test_requested)
+        if(test_requested || perf_test_requested || catalog_requested)
         {
-            cout << "error : no other argument can be passed if a test is requested\n";
+            cout << "error : no other argument can be passed if a test or the catalog is requested\n";
             has_error = true;
         }
         else if(equal_op(argv[2],"record"))
         {
             record_requested = true;
         }
+        else if(equal_op(argv[2],"solve"))
+        {
+            solve_requested = true;
+        }
         else
         {
             cout << "error : incorrect argument\n";
@@ -449,7 +611,7 @@ int main(int argc, char *argv[])
 
     if(test_requested)
     {
-        if(run_tests(resources_folder_path, false, nullptr) && run_tests(resources_folder_path, true, nullptr))
+        if(run_tests(resources_folder_path, GameSource::FileTextProvider, nullptr) && run_tests(resources_folder_path, GameSource::StringTextProvider, nullptr) && run_tests(resources_folder_path, GameSource::SerializedGame, nullptr))
         {
             cout << "All tests completed with success !\n";
         }
@@ -465,13 +627,17 @@ int main(int argc, char *argv[])
         for(int i = 0; i < run_number; ++i)
         {
             timers.push_back(std::chrono::microseconds());
-            run_tests(resources_folder_path,false, &timers.back());
+            run_tests(resources_folder_path,GameSource::FileTextProvider, &timers.back());
         }
 
         auto total = std::accumulate(timers.begin(),timers.end(),0, [](auto sum, auto current){return sum + current.count();});
         auto mean =  total / run_number;
         cout << "ran the tests " << to_string(run_number) << " times. total execution time : "<< to_string(total) <<" microseconds. mean execution time : "<< to_string(mean) <<" microseconds\n.";
     }
+    else if(catalog_requested)
+    {
+        load_catalog(resources_folder_path);
+    }
     else
     {
         string file_path = resources_folder_path + file_name;
@@ -480,6 +646,10 @@ int main(int argc, char *argv[])
         {
             run_game_and_record_test_file(resources_folder_path,file_name);
         }
+        else if(solve_requested)
+        {
+            solve_game_and_record_test_file(resources_folder_path,file_name);
+        }
         else
         {
             load_and_run_game(file_path);